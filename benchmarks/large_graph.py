@@ -0,0 +1,24 @@
+# full collections over a large live object graph, dominated by marking
+import gc
+
+class Node:
+    def __init__(self, i):
+        self.id = i
+        self.edges = []
+
+N = 400000
+nodes = [Node(i) for i in range(N)]
+for i in range(N):
+    edges = nodes[i].edges
+    edges.append(nodes[(i * 7 + 1) % N])
+    edges.append(nodes[(i * 13 + 5) % N])
+    edges.append({'w': i, 'next': nodes[(i + 1) % N]})
+# a wide tree too, so there is plenty of work to share from the start
+tree = [[[(i, j, k) for k in range(8)] for j in range(16)] for i in range(2000)]
+
+for _ in range(20):
+    garbage = [Node(i) for i in range(1000)]
+    gc.collect()
+
+assert nodes[N - 1].edges[2]['next'] is nodes[0]
+assert tree[1999][15][7] == (1999, 15, 7)
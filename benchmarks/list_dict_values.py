@@ -0,0 +1,23 @@
+# large lists and dicts of unboxed values, dominated by the size of py_TValue
+N = 2000000
+
+ints = list(range(N))
+floats = [i * 0.5 for i in range(N)]
+table = {i: i * 2 for i in range(N // 4)}
+
+total = 0
+for _ in range(3):
+    for x in ints:
+        total += x
+    for x in floats:
+        total += x
+    for k in table:
+        total += table[k]
+
+rows = [[j for j in range(16)] for i in range(N // 16)]
+s = 0
+for row in rows:
+    s += row[15]
+
+assert total == 3 * (N * (N - 1) // 2 + N * (N - 1) // 4 + (N // 4) * (N // 4 - 1))
+assert s == 15 * (N // 16)
@@ -0,0 +1,23 @@
+# allocation-heavy workload of objects between 160 bytes and a few KB
+from vmath import mat3x3
+
+class Particle:
+    def __init__(self, i):
+        self.pos = (i, i + 1, i + 2)
+        self.vel = (1, 0, -1)
+        self.tags = ('a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', i)
+
+def make_adder(i):
+    def add(x):
+        return x + i
+    return add
+
+total = 0
+for n in range(100):
+    rows = [tuple(range(j % 100)) for j in range(2000)]
+    particles = [Particle(j) for j in range(1000)]
+    adders = [make_adder(j) for j in range(1000)]
+    mats = [mat3x3.identity() for _ in range(1000)]
+    total += len(rows[-1]) + particles[-1].tags[-1] + adders[-1](n) + int(mats[-1][0, 0])
+
+assert total == 100 * (99 + 999 + 999 + 1) + sum([n for n in range(100)])
@@ -12,14 +12,31 @@
 #define PK_USE_PTHREADS 1
 typedef pthread_t c11_thrd_t;
 typedef void* c11_thrd_retval_t;
+typedef pthread_mutex_t c11_mtx_t;
+typedef pthread_cond_t c11_cnd_t;
 #else
 #include <threads.h>
 #define PK_USE_PTHREADS 0
 typedef thrd_t c11_thrd_t;
 typedef int c11_thrd_retval_t;
+typedef mtx_t c11_mtx_t;
+typedef cnd_t c11_cnd_t;
 #endif
 
 bool c11_thrd_create(c11_thrd_t* thrd, c11_thrd_retval_t (*func)(void*), void* arg);
+void c11_thrd_join(c11_thrd_t thrd);
 void c11_thrd_yield();
+// number of processors online, at least 1
+int c11_thrd_processor_count();
+
+void c11_mtx_init(c11_mtx_t* mtx);
+void c11_mtx_destroy(c11_mtx_t* mtx);
+void c11_mtx_lock(c11_mtx_t* mtx);
+void c11_mtx_unlock(c11_mtx_t* mtx);
+
+void c11_cnd_init(c11_cnd_t* cnd);
+void c11_cnd_destroy(c11_cnd_t* cnd);
+void c11_cnd_wait(c11_cnd_t* cnd, c11_mtx_t* mtx);
+void c11_cnd_broadcast(c11_cnd_t* cnd);
 
 #endif
\ No newline at end of file
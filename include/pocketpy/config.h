@@ -31,17 +31,75 @@
 #define PK_ENABLE_MIMALLOC          0                
 #endif
 
+#ifndef PK_ENABLE_COMPUTED_GOTO     // can be overridden by cmake
+#define PK_ENABLE_COMPUTED_GOTO     1
+#endif
+
+#ifndef PK_ENABLE_OPCODE_STATS      // can be overridden by cmake
+#define PK_ENABLE_OPCODE_STATS      0
+#endif
+
+// Collect young objects separately from the long-lived ones
+// 0 falls back to a full mark-sweep on every collection
+#ifndef PK_ENABLE_GENERATIONAL_GC   // can be overridden by cmake
+#define PK_ENABLE_GENERATIONAL_GC   1
+#endif
+
+// Spread full collections over many small steps paced by allocations
+// 0 stops the world until a full collection is finished
+#ifndef PK_ENABLE_INCREMENTAL_GC    // can be overridden by cmake
+#define PK_ENABLE_INCREMENTAL_GC    1
+#endif
+
+// Track live objects by type and by allocating source line, see `pkpy.heap_census()`
+// Adds 8 bytes to every object header
+#ifndef PK_ENABLE_HEAP_PROFILER     // can be overridden by cmake
+#define PK_ENABLE_HEAP_PROFILER     0
+#endif
+
+// Share the marking of full collections among `PK_GC_MARK_THREADS` threads
+// Requires `PK_ENABLE_THREADS`
+#ifndef PK_ENABLE_PARALLEL_MARK     // can be overridden by cmake
+#define PK_ENABLE_PARALLEL_MARK     0
+#endif
+
+#if PK_ENABLE_PARALLEL_MARK && !PK_ENABLE_THREADS
+    #error "PK_ENABLE_PARALLEL_MARK requires PK_ENABLE_THREADS"
+#endif
+
+// Use a 16-byte `py_TValue` with an 8-byte payload instead of a 24-byte one
+// `vec3` and `vec3i` are boxed, only strings shorter than 8 bytes are stored inline
+#ifndef PK_ENABLE_COMPACT_TVALUE    // can be overridden by cmake
+#define PK_ENABLE_COMPACT_TVALUE    0
+#endif
+
+// Number of threads marking in parallel, including the collecting one
+#ifndef PK_GC_MARK_THREADS          // can be overridden by cmake
+    #define PK_GC_MARK_THREADS      4
+#endif
+
 // GC min threshold
 #ifndef PK_GC_MIN_THRESHOLD         // can be overridden by cmake
     #define PK_GC_MIN_THRESHOLD     32768
 #endif
 
+// Fuel units burnt between two clock() checks of a time-limited watchdog
+#ifndef PK_WATCHDOG_CLOCK_INTERVAL  // can be overridden by cmake
+    #define PK_WATCHDOG_CLOCK_INTERVAL  4096
+#endif
+
 // This is the maximum size of the value stack in py_TValue units
 // The actual size in bytes equals `sizeof(py_TValue) * PK_VM_STACK_SIZE`
 #ifndef PK_VM_STACK_SIZE            // can be overridden by cmake
     #define PK_VM_STACK_SIZE        16384
 #endif
 
+// This is the number of frames preallocated next to the value stack
+// Deeper call chains fall back to heap-allocated frames
+#ifndef PK_VM_FRAME_STACK_SIZE      // can be overridden by cmake
+    #define PK_VM_FRAME_STACK_SIZE  1024
+#endif
+
 // This is the maximum number of local variables in a function
 // (not recommended to change this)
 #ifndef PK_MAX_CO_VARNAMES          // can be overridden by cmake
@@ -49,6 +107,13 @@
 #endif
 
 /*************** internal settings ***************/
+// This is the size of the payload of `py_TValue` in bytes
+#if PK_ENABLE_COMPACT_TVALUE
+    #define PK_TVALUE_PAYLOAD_SIZE  8
+#else
+    #define PK_TVALUE_PAYLOAD_SIZE  16
+#endif
+
 // This is the maximum character length of a module path
 #define PK_MAX_MODULE_PATH_LEN      63
 
@@ -103,3 +168,19 @@
         #endif
     #endif
 #endif
+
+// Aligned memory allocation functions, `size` is a multiple of `align`
+#ifndef PK_ALIGNED_MALLOC
+    #if PK_ENABLE_MIMALLOC
+        #define PK_ALIGNED_MALLOC(size, align)  mi_malloc_aligned(size, align)
+        #define PK_ALIGNED_FREE(ptr)            mi_free(ptr)
+    #elif defined(_WIN32)
+        #include <malloc.h>
+        #define PK_ALIGNED_MALLOC(size, align)  _aligned_malloc(size, align)
+        #define PK_ALIGNED_FREE(ptr)            _aligned_free(ptr)
+    #else
+        #include <stdlib.h>
+        #define PK_ALIGNED_MALLOC(size, align)  aligned_alloc(align, size)
+        #define PK_ALIGNED_FREE(ptr)            free(ptr)
+    #endif
+#endif
@@ -5,7 +5,6 @@
 #include "pocketpy/pocketpy.h"
 
 void FastLocals__to_dict(py_TValue* locals, const CodeObject* co) PY_RETURN;
-NameDict* FastLocals__to_namedict(py_TValue* locals, const CodeObject* co);
 
 typedef struct ValueStack {
     py_TValue* sp;
@@ -17,15 +16,6 @@ typedef struct ValueStack {
 void ValueStack__ctor(ValueStack* self);
 void ValueStack__dtor(ValueStack* self);
 
-typedef struct UnwindTarget {
-    struct UnwindTarget* next;
-    int iblock;
-    int offset;
-} UnwindTarget;
-
-UnwindTarget* UnwindTarget__new(UnwindTarget* next, int iblock, int offset);
-void UnwindTarget__delete(UnwindTarget* self);
-
 typedef struct py_Frame {
     struct py_Frame* f_back;
     const CodeObject* co;
@@ -35,7 +25,6 @@ typedef struct py_Frame {
     py_Ref locals;
     bool is_locals_special;
     int ip;
-    UnwindTarget* uw_list;
 } py_Frame;
 
 typedef struct SourceLocation {
@@ -43,12 +32,27 @@ typedef struct SourceLocation {
     int lineno;
 } SourceLocation;
 
+typedef struct FrameStack {
+    py_Frame* sp;
+    py_Frame* end;
+    py_Frame begin[PK_VM_FRAME_STACK_SIZE];
+} FrameStack;
+
+void FrameStack__ctor(FrameStack* self);
+
+// allocates on the frame stack, falls back to the heap when it is full
 py_Frame* Frame__new(const CodeObject* co,
                   py_StackRef p0,
                   py_GlobalRef module,
                   py_Ref globals,
                   py_Ref locals,
                   bool is_locals_special);
+// allocates on the heap, for frames that outlive their caller (generators)
+py_Frame* Frame__new_detached(const CodeObject* co,
+                              py_StackRef p0,
+                              py_GlobalRef module,
+                              py_Ref globals,
+                              py_Ref locals);
 void Frame__delete(py_Frame* self);
 
 int Frame__lineno(const py_Frame* self);
@@ -58,13 +62,11 @@ int Frame__getglobal(py_Frame* self, py_Name name) PY_RAISE PY_RETURN;
 bool Frame__setglobal(py_Frame* self, py_Name name, py_TValue* val) PY_RAISE;
 int Frame__delglobal(py_Frame* self, py_Name name) PY_RAISE;
 
-py_Ref Frame__getclosure(py_Frame* self, py_Name name);
 py_StackRef Frame__getlocal_noproxy(py_Frame* self, py_Name name);
 
+// stack pointer of this frame when no block keeps values on the stack
+py_StackRef Frame__stack_base(py_Frame* self);
 int Frame__prepare_jump_exception_handler(py_Frame* self, ValueStack*);
 
-UnwindTarget* Frame__find_unwind_target(py_Frame* self, int iblock);
-void Frame__set_unwind_target(py_Frame* self, py_TValue* sp);
-
 void Frame__gc_mark(py_Frame* self, c11_vector* p_stack);
 SourceLocation Frame__source_location(py_Frame* self);
\ No newline at end of file
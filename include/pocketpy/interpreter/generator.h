@@ -6,8 +6,18 @@
 typedef struct Generator{
     py_Frame* frame;
     int state;
+    // stack segment of the suspended frame, owned by the generator
+    py_TValue* backup;
+    int backup_length;
+    int backup_capacity;
 } Generator;
 
 void pk_newgenerator(py_Ref out, py_Frame* frame, py_TValue* begin, py_TValue* end);
 
-void Generator__dtor(Generator* ud);
\ No newline at end of file
+void Generator__dtor(Generator* ud);
+void Generator__gc_mark(Generator* ud, c11_vector* p_stack);
+
+/// Resume a generator without raising `StopIteration`.
+/// Returns 1 if it yields, 0 if it is exhausted, -1 on error.
+/// The yielded or returned value is stored in `py_retval()`.
+int pk_generator_resume(py_Ref self) PY_RAISE PY_RETURN;
@@ -3,10 +3,53 @@
 #include "pocketpy/objects/object.h"
 #include "pocketpy/interpreter/objectpool.h"
 
+typedef enum GCPhase {
+    GCPhase_IDLE,
+    GCPhase_MARK,   // incremental marking, `gc_roots` holds the gray objects
+    GCPhase_SWEEP,  // incremental sweeping, arena by arena
+} GCPhase;
+
+// collections kept for `gc.get_stats()`
+#define kGCStatsLength 32
+
+typedef struct GCStats {
+    int64_t start_ns;  // wall clock time, same as `time.time_ns()`
+    int64_t mark_ns;
+    int64_t sweep_ns;  // young arenas are swept lazily afterwards, which is not included
+    int freed_small[kMultiPoolCount];  // freed objects of each pool
+    int freed_large;
+    int marked;      // objects visited by marking
+    int threshold;   // `gc_threshold` after the collection
+    int generation;  // 0 for a young collection, 1 for a full one
+    bool incremental;
+} GCStats;
+
 typedef struct ManagedHeap {
     MultiPool small_objects;
     c11_vector /* PyObject_p */ large_objects;
     c11_vector /* PyObject_p */ gc_roots;
+    // marked objects written since they were marked
+    c11_vector /* PyObject_p */ remembered;
+    // frozen objects written after `gc.freeze()`
+    c11_vector /* PyObject_p */ frozen_roots;
+    int frozen_count;
+#if PK_ENABLE_GENERATIONAL_GC
+    int large_old_length;  // large_objects[:large_old_length] are old
+    int promoted;          // objects promoted since the last full collection
+    int survived;          // objects survived the last full collection
+#endif
+#if PK_ENABLE_PARALLEL_MARK
+    struct MarkWorkers* mark_workers;  // threads of parallel marking, started on first use
+#endif
+
+    GCPhase gc_phase;
+    int gc_marked;  // objects marked in the current incremental collection
+    int gc_freed;   // large objects freed in the current incremental collection
+
+    // gc_stats[gc_stats_count % kGCStatsLength] is the current or the next collection
+    GCStats gc_stats[kGCStatsLength];
+    int gc_stats_count;     // finished collections
+    bool gc_in_callbacks;  // `gc.callbacks` are running, collections are skipped
 
     int freed_ma[3];
     int gc_threshold;  // threshold for gc_counter
@@ -18,12 +61,46 @@ void ManagedHeap__ctor(ManagedHeap* self);
 void ManagedHeap__dtor(ManagedHeap* self);
 
 void ManagedHeap__collect_if_needed(ManagedHeap* self);
+// full collection, an incremental collection in progress is finished first
 int ManagedHeap__collect(ManagedHeap* self);
-int ManagedHeap__sweep(ManagedHeap* self);
+// collect young objects only, same as a full collection if generational gc is disabled
+int ManagedHeap__collect_young(ManagedHeap* self);
+int ManagedHeap__sweep(ManagedHeap* self, bool young_only);
+// advance the incremental collection for at most `budget_us` microseconds
+// returns true if no collection is in progress after this step
+bool ManagedHeap__step(ManagedHeap* self, int budget_us);
+// move all live objects into a permanent generation that is neither traversed nor swept
+void ManagedHeap__freeze(ManagedHeap* self);
+void ManagedHeap__unfreeze(ManagedHeap* self);
 
 #define ManagedHeap__new(self, type, slots, udsize)                                                \
     ManagedHeap__gcnew((self), (type), (slots), (udsize))
 PyObject* ManagedHeap__gcnew(ManagedHeap* self, py_Type type, int slots, int udsize);
 
+void ManagedHeap__remember(PyObject* obj);
+
+// must be called after storing a reference into `obj` by any means other than the public api
+// a marked object is either old or already visited by an incremental collection
+#define pk__write_barrier(obj)                                                                     \
+    do {                                                                                           \
+        PyObject* _obj = (obj);                                                                    \
+        if(!_obj->gc_remembered && PyObject__is_marked(_obj)) ManagedHeap__remember(_obj);         \
+    } while(0)
+
 // external implementation
-void ManagedHeap__mark(ManagedHeap* self);
+// call `gc.callbacks` with `phase` and the stats of the current collection
+void ManagedHeap__fire_callbacks(ManagedHeap* self, const char* phase, const GCStats* stats);
+void ManagedHeap__mark_roots(ManagedHeap* self);
+void ManagedHeap__mark_remembered(ManagedHeap* self);
+// visit at most `budget` gray objects, or all of them if `budget` is -1
+// returns the number of visited objects
+int ManagedHeap__mark_gray(ManagedHeap* self, int budget);
+// returns the number of newly marked objects
+// a `full` mark may share the work among threads if `PK_ENABLE_PARALLEL_MARK` is enabled
+int ManagedHeap__mark(ManagedHeap* self, bool full);
+#if PK_ENABLE_PARALLEL_MARK
+// stop the threads of parallel marking
+void ManagedHeap__stop_mark_workers(ManagedHeap* self);
+#endif
+// remember marked objects that native code may still be filling in
+void ManagedHeap__remember_temporaries(ManagedHeap* self);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "pocketpy/pocketpy.h"
+
+#include "pocketpy/interpreter/frame.h"
+#include "pocketpy/interpreter/heap.h"
+
+#if PK_ENABLE_HEAP_PROFILER
+
+// a python source line that allocates objects
+typedef struct HeapSite {
+    SourceData_ src;  // NULL for objects allocated without a python frame
+    int lineno;
+    py_i64 allocated;  // objects ever allocated here
+} HeapSite;
+
+typedef struct HeapCensusRow {
+    py_i64 count;
+    py_i64 bytes;
+} HeapCensusRow;
+
+typedef struct HeapProfiler {
+    c11_smallmap_p2i lines;          // SourceData* -> int[] site index of each line
+    c11_vector /*T=HeapSite*/ sites;  // sites[0] is native code
+    c11_vector /*T=py_i64*/ allocated;  // objects ever allocated of each type
+    // the lines of the last recorded source, most allocations repeat it
+    SourceData_ last_src;
+    int* last_lines;
+} HeapProfiler;
+
+void HeapProfiler__ctor(HeapProfiler* self);
+void HeapProfiler__dtor(HeapProfiler* self);
+// count a new object of `type` and return the index of its allocation site
+int HeapProfiler__record(HeapProfiler* self, py_Type type, py_Frame* frame);
+// count the live objects and bytes by type and by site, `heap` must be fully swept
+// `types` and `sites` are vectors of `HeapCensusRow`
+void HeapProfiler__census(HeapProfiler* self,
+                          ManagedHeap* heap,
+                          c11_vector* types,
+                          c11_vector* sites);
+
+#endif
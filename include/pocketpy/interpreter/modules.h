@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 void pk__add_module_os();
 void pk__add_module_sys();
 void pk__add_module_io();
@@ -38,3 +40,6 @@ void pk__add_module_cute_png();
 #else
 #define pk__add_module_cute_png()
 #endif
+
+// wall clock time in nanoseconds, same as `time.time_ns()`
+int64_t time_ns(void);
@@ -4,8 +4,14 @@
 #include "pocketpy/common/str.h"
 
 #define kPoolArenaSize (120 * 1024)
-#define kMultiPoolCount 5
-#define kPoolMaxBlockSize (32 * kMultiPoolCount)
+// arenas are allocated at this alignment, so the arena of a pooled object is found by masking
+#define kPoolArenaAlign (128 * 1024)
+// block sizes are multiples of 32 bytes, the bitmaps hold one bit per 32-byte granule
+#define kPoolGranuleShift 5
+#define kPoolBitmapLength (kPoolArenaSize >> kPoolGranuleShift >> 6)
+// small size classes step by 32 bytes, medium ones grow geometrically up to a few KB
+#define kMultiPoolCount 19
+#define kPoolMaxBlockSize 4096
 
 typedef uint16_t PoolBlockIndex;
 
@@ -29,6 +35,11 @@ typedef struct PoolArena {
     int unused_length;
     PoolBlockIndex* unused;
     UsedBlockList used_blocks;
+    bool dirty;  // allocated from since the last sweep, i.e. may hold young objects
+    // gc state is kept out of the object headers, so sweeping does not touch live objects
+    uint64_t allocated[kPoolBitmapLength];
+    uint64_t marks[kPoolBitmapLength];
+    uint64_t frozen[kPoolBitmapLength];  // permanently marked by `gc.freeze()`
 
     union {
         char data[kPoolArenaSize];
@@ -36,18 +47,40 @@ typedef struct PoolArena {
     };
 } PoolArena;
 
+#define PoolArena__of(obj)                                                                         \
+    ((PoolArena*)((uintptr_t)(obj) & ~(uintptr_t)(kPoolArenaAlign - 1)))
+#define PoolArena__granule(arena, obj)                                                             \
+    ((int)(((char*)(obj) - (arena)->data) >> kPoolGranuleShift))
+
+#define PoolArena__bitmap_get(bitmap, i) (((bitmap)[(i) >> 6] >> ((i) & 63)) & 1)
+#define PoolArena__bitmap_set(bitmap, i) ((bitmap)[(i) >> 6] |= (uint64_t)1 << ((i) & 63))
+#define PoolArena__bitmap_reset(bitmap, i) ((bitmap)[(i) >> 6] &= ~((uint64_t)1 << ((i) & 63)))
+
 typedef struct Pool {
     c11_vector /* PoolArena* */ arenas;
     c11_vector /* PoolArena* */ no_free_arenas;
+    c11_vector /* PoolArena* */ unswept_arenas;  // swept before allocating from them
     int block_size;
 } Pool;
 
 typedef struct MultiPool {
     Pool pools[kMultiPoolCount];
+    uint8_t size_classes[kPoolMaxBlockSize >> kPoolGranuleShift];  // granules -> pool index
 } MultiPool;
 
 void* MultiPool__alloc(MultiPool* self, int size);
-int MultiPool__sweep_dealloc(MultiPool* self);
+void MultiPool__unmark(MultiPool* self);
+// move all allocated objects into the permanent generation, returns the number of them
+int MultiPool__freeze(MultiPool* self);
+void MultiPool__unfreeze(MultiPool* self);
+// call `f` on every allocated object, there must be no unswept arenas
+void MultiPool__visit(MultiPool* self, void (*f)(void* obj, void* ctx), void* ctx);
+// defer sweeping of all arenas, or the ones allocated from since the last sweep if `young_only`
+// returns the number of unmarked objects in them, which are freed when an arena is swept
+// the unmarked objects of each pool are added to `freed`
+int MultiPool__begin_sweep(MultiPool* self, bool young_only, int freed[kMultiPoolCount]);
+// sweep deferred arenas until `*budget` blocks are visited, returns true if all are swept
+bool MultiPool__sweep_step(MultiPool* self, int* budget);
 void MultiPool__ctor(MultiPool* self);
 void MultiPool__dtor(MultiPool* self);
 c11_string* MultiPool__summary(MultiPool* self);
\ No newline at end of file
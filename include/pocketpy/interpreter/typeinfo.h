@@ -4,6 +4,13 @@
 #include "pocketpy/common/vector.h"
 #include "pocketpy/objects/object.h"
 
+typedef enum MagicSlot {
+#define MAGIC_METHOD(x) MagicSlot_##x,
+#include "pocketpy/xmacros/magics.h"
+#undef MAGIC_METHOD
+    MagicSlot__COUNT,
+} MagicSlot;
+
 typedef struct py_TypeInfo {
     py_Name name;
     py_Type index;
@@ -16,6 +23,16 @@ typedef struct py_TypeInfo {
     bool is_python;  // is it a python class? (not derived from c object)
     bool is_final;  // can it be subclassed?
 
+    // version tag for inline caches, 0 means unassigned
+    // it is reset when the dict of this type or any of its bases is modified
+    uint32_t version;
+
+    // lazily resolved magic methods, one per entry in xmacros/magics.h
+    // `magics[i]` is valid if bit `i` of `magics_resolved` is set and `magics_version == version`
+    uint32_t magics_version;
+    uint64_t magics_resolved;
+    py_ItemRef magics[MagicSlot__COUNT];
+
     bool (*getattribute)(py_Ref self, py_Name name) PY_RAISE PY_RETURN;
     bool (*setattribute)(py_Ref self, py_Name name, py_Ref val) PY_RAISE PY_RETURN;
     bool (*delattribute)(py_Ref self, py_Name name) PY_RAISE;
@@ -28,7 +45,13 @@ typedef struct py_TypeInfo {
 
 py_TypeInfo* pk_typeinfo(py_Type type);
 py_ItemRef pk_tpfindname(py_TypeInfo* ti, py_Name name);
-#define pk_tpfindmagic pk_tpfindname
+py_ItemRef pk_tpfindmagic(py_TypeInfo* ti, py_Name name);
+py_ItemRef pk_tpfindmagicslot(py_TypeInfo* ti, MagicSlot slot);
+int pk_magicslot(py_Name name);  // -1 if `name` is not a magic name
+void pk_magicslots_initialize();
+
+uint32_t pk_tpversion(py_TypeInfo* ti);
+void pk_tpmodified(py_TypeInfo* ti);
 
 py_Type pk_newtype(const char* name,
                    py_Type base,
@@ -13,6 +13,7 @@ typedef struct {
     int length;
     uint32_t capacity;
     uint32_t null_index_value;
+    uint32_t version;  // changed by every insertion and deletion
     bool index_is_short;
     void* indices;
     c11_vector /*T=DictEntry*/ entries;
@@ -20,5 +21,11 @@ typedef struct {
 
 typedef c11_vector List;
 
+typedef struct {
+    py_i64 start;
+    py_i64 stop;
+    py_i64 step;
+} Range;
+
 void c11_chunked_array2d__mark(void* ud, c11_vector* p_stack);
 void function__gc_mark(void* ud, c11_vector* p_stack);
@@ -10,6 +10,7 @@
 #include "pocketpy/interpreter/frame.h"
 #include "pocketpy/interpreter/typeinfo.h"
 #include "pocketpy/interpreter/line_profiler.h"
+#include "pocketpy/interpreter/heap_profiler.h"
 #include <time.h>
 
 // TODO:
@@ -25,8 +26,11 @@ typedef struct TraceInfo {
     py_TraceFunc func;
 } TraceInfo;
 
+// fuel is burnt on backward jumps (by the jump distance) and on frame switches (by 1)
 typedef struct WatchdogInfo {
-    clock_t max_reset_time;
+    py_i64 fuel;             // units left before the next check
+    clock_t max_reset_time;  // deadline of a time-limited watchdog, 0 if none
+    bool is_fuel_limited;    // raise when `fuel` runs out instead of refilling it
 } WatchdogInfo;
 
 typedef struct TypePointer {
@@ -39,6 +43,9 @@ typedef struct py_ModuleInfo {
     c11_string* package;
     c11_string* path;
     py_GlobalRef self;  // weakref to the original module object
+    // bumped when a key is added to or removed from the module dict
+    // values can be updated in place without changing it
+    uint32_t dict_version;
 } py_ModuleInfo;
 
 typedef struct VM {
@@ -46,6 +53,8 @@ typedef struct VM {
 
     BinTree modules;
     c11_vector /*TypePointer*/ types;
+    uint32_t next_type_version;
+    uint32_t next_decl_uid;
 
     py_GlobalRef builtins;  // builtins module
     py_GlobalRef main;      // __main__ module
@@ -71,10 +80,16 @@ typedef struct VM {
     TraceInfo trace_info;
     WatchdogInfo watchdog_info;
     LineProfiler line_profiler;
+#if PK_ENABLE_OPCODE_STATS
+    uint64_t (*opcode_pairs)[OP__COUNT];  // counts of executed (prev, next) opcode pairs
+#endif
+#if PK_ENABLE_HEAP_PROFILER
+    HeapProfiler heap_profiler;
+#endif
     py_TValue vectorcall_buffer[PK_MAX_CO_VARNAMES];
 
-    FixedMemoryPool pool_frame;
     ManagedHeap heap;
+    FrameStack frame_stack;
     ValueStack stack;  // put `stack` at the end for better cache locality
 } VM;
 
@@ -106,7 +121,7 @@ typedef enum FrameResult {
 
 FrameResult VM__run_top_frame(VM* self);
 
-FrameResult VM__vectorcall(VM* self, uint16_t argc, uint16_t kwargc, bool opcall);
+FrameResult VM__vectorcall(VM* self, uint16_t argc, uint16_t kwargc, bool opcall, CallCache* cache);
 
 const char* pk_opname(Opcode op);
 
@@ -115,6 +130,9 @@ bool pk_wrapper__arrayequal(py_Type type, int argc, py_Ref argv);
 bool pk_arraycontains(py_Ref self, py_Ref val);
 
 bool pk_loadmethod(py_StackRef self, py_Name name);
+bool pk_loadmethod_cached(py_StackRef self, py_Name name, AttrCache* cache);
+bool pk_getattr_cached(py_Ref self, py_Name name, AttrCache* cache) PY_RAISE PY_RETURN;
+bool pk_setattr_cached(py_Ref self, py_Name name, py_Ref val, AttrCache* cache) PY_RAISE;
 bool pk_callmagic(py_Name name, int argc, py_Ref argv);
 
 bool pk_exec(CodeObject* co, py_Ref module);
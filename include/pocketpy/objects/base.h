@@ -19,10 +19,13 @@ typedef struct py_TValue {
         PyObject* _obj;
         c11_vec2 _vec2;
         c11_vec2i _vec2i;
+#if !PK_ENABLE_COMPACT_TVALUE
+        // boxed in compact mode, they do not fit in 8 bytes
         c11_vec3 _vec3;
         c11_vec3i _vec3i;
+#endif
         c11_color32 _color32;
         void* _ptr;
-        char _chars[16];
+        char _chars[PK_TVALUE_PAYLOAD_SIZE];
     };
 } py_TValue;
@@ -45,6 +45,13 @@ typedef enum Opcode {
 #undef OPCODE
 } Opcode;
 
+enum {
+    OP__COUNT = 0
+#define OPCODE(name) +1
+#include "pocketpy/xmacros/opcodes.h"
+#undef OPCODE
+};
+
 typedef struct Bytecode {
     uint8_t op;
     uint16_t arg;
@@ -61,11 +68,53 @@ typedef struct CodeBlock {
     int end2;    // ...
 } CodeBlock;
 
+// exception table entry of a try block, only consulted when an exception is raised
+typedef struct ExceptionHandler {
+    int start;   // first bytecode of the try block, inclusive
+    int end;     // last bytecode of the try block, exclusive
+    int target;  // bytecode to jump to when an exception is raised in [start, end)
+    int depth;   // number of values kept on the stack by the enclosing blocks
+} ExceptionHandler;
+
 typedef struct BytecodeEx {
     int lineno;       // line number for each bytecode
     int iblock;       // block index
+    int icache;       // inline cache index, -1 if this bytecode has no cache
 } BytecodeEx;
 
+typedef enum AttrCacheKind {
+    AttrCacheKind_EMPTY,
+    AttrCacheKind_INSTANCE,     // found in the instance dict at `hint`
+    AttrCacheKind_CLASS,        // found in the class dict as `cls_var`
+    AttrCacheKind_PROPERTY,     // `cls_var` is a property
+    AttrCacheKind_METHOD,       // `cls_var` is a function to be pushed with self
+    AttrCacheKind_STATICMETHOD, // `cls_var` is a staticmethod
+    AttrCacheKind_CLASSMETHOD,  // `cls_var` is a classmethod
+} AttrCacheKind;
+
+// inline cache for LOAD_ATTR, LOAD_METHOD and STORE_ATTR
+typedef struct AttrCache {
+    py_Type type;       // receiver type
+    uint8_t kind;       // AttrCacheKind
+    uint32_t version;   // version of `type` when this entry was filled
+    int hint;           // slot index in the instance dict
+    py_ItemRef cls_var; // item in the class dict, valid while `version` matches
+} AttrCache;
+
+// inline cache for LOAD_GLOBAL, LOAD_NONLOCAL and LOAD_CLOSURE, used when globals is a module
+typedef struct GlobalCache {
+    PyObject* module;           // module used as globals, NULL if empty
+    uint32_t module_version;    // dict version of `module` when this entry was filled
+    uint32_t builtins_version;  // dict version of builtins if `slot` is a builtin, otherwise 0
+    py_ItemRef slot;            // resolved item, valid while the versions match
+} GlobalCache;
+
+// inline cache for CALL with keyword arguments
+typedef struct CallCache {
+    uint32_t decl_uid;  // uid of the callee's FuncDecl when this entry was filled, 0 if empty
+    int16_t* kw_layout;  // local index of each keyword argument, -1 for **kwargs
+} CallCache;
+
 typedef struct CodeObject {
     SourceData_ src;
     c11_string* name;
@@ -82,8 +131,14 @@ typedef struct CodeObject {
     c11_smallmap_n2d names_inv;
 
     c11_vector /*T=CodeBlock*/ blocks;
+    c11_vector /*T=ExceptionHandler*/ exc_handlers;  // outer try blocks come first
     c11_vector /*T=FuncDecl_*/ func_decls;
 
+    c11_vector /*T=AttrCache*/ attr_caches;
+    c11_vector /*T=GlobalCache*/ global_caches;
+    c11_vector /*T=CallCache*/ call_caches;
+    c11_vector /*T=int16_t*/ call_kw_layouts;  // storage of `CallCache.kw_layout`
+
     int start_line;
     int end_line;
 } CodeObject;
@@ -92,6 +147,7 @@ void CodeObject__ctor(CodeObject* self, SourceData_ src, c11_sv name);
 void CodeObject__dtor(CodeObject* self);
 int CodeObject__add_varname(CodeObject* self, py_Name name);
 int CodeObject__add_name(CodeObject* self, py_Name name);
+void CodeObject__init_caches(CodeObject* self);
 void CodeObject__gc_mark(const CodeObject* self, c11_vector* p_stack);
 
 typedef struct FuncDeclKwArg {
@@ -100,6 +156,20 @@ typedef struct FuncDeclKwArg {
     py_TValue value;  // default value
 } FuncDeclKwArg;
 
+typedef enum CaptureKind {
+    CaptureKind_UNBOUND,  // not a variable of any enclosing function
+    CaptureKind_LOCAL,    // a local of the enclosing function
+    CaptureKind_CLOSURE,  // a closure slot of the enclosing function
+    CaptureKind_SELF,     // the function itself, to allow recursion
+} CaptureKind;
+
+// a variable captured by a nested function, stored in a slot of the function object
+typedef struct FuncDeclCapture {
+    py_Name name;      // name of this variable
+    CaptureKind kind;  // where to copy it from when the function is created
+    int index;         // index in the enclosing co->varnames or closure slots
+} FuncDeclCapture;
+
 typedef struct FuncDecl {
     RefCounted rc;
     CodeObject code;  // strong ref
@@ -110,11 +180,13 @@ typedef struct FuncDecl {
     int starred_arg;    // index in co->varnames, -1 if no *arg
     int starred_kwarg;  // index in co->varnames, -1 if no **kwarg
     bool nested;        // whether this function is nested
+    c11_vector /*T=FuncDeclCapture*/ captures;  // closure slots, resolved by the compiler
 
     const char* docstring;  // docstring of this function (weak ref)
 
     FuncType type;
     c11_smallmap_n2d kw_to_index;
+    uint32_t uid;  // identifies this decl in call caches, 0 if not assigned yet
 } FuncDecl;
 
 typedef FuncDecl* FuncDecl_;
@@ -132,7 +204,6 @@ typedef struct Function {
     FuncDecl_ decl;
     py_GlobalRef module;    // maybe NULL, weak ref
     py_Ref globals;         // maybe NULL, strong ref
-    NameDict* closure;      // maybe NULL, strong ref
     PyObject* clazz;        // weak ref; for super()
     py_CFunction cfunc;     // wrapped C function; for decl-based binding
 } Function;
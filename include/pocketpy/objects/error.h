@@ -9,4 +9,5 @@ typedef struct{
     char msg[512];
 } Error;
 
-void py_BaseException__stpush(py_Frame* frame, py_Ref, SourceData_ src, int lineno, const char* func_name);
+void py_BaseException__stpush(py_Frame* frame, py_Ref self);
+void py_BaseException__stpush_source(py_Ref self, SourceData_ src, int lineno);
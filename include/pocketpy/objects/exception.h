@@ -1,19 +1,25 @@
 #pragma once
 
 #include "pocketpy/objects/sourcedata.h"
+#include "pocketpy/objects/codeobject.h"
 #include "pocketpy/objects/base.h"
 
+// One entry of a traceback. Frames of functions only record `(decl, ip)` while unwinding,
+// source locations are resolved when the traceback is formatted.
 typedef struct BaseExceptionFrame {
     SourceData_ src;
-    int lineno;
-    c11_string* name;
+    int lineno;         // -1 if it is resolved from `decl` and `ip`
+    FuncDecl_ decl;     // strong ref, NULL for module or class bodies
+    int ip;
     py_TValue locals;   // for debugger only
     py_TValue globals;  // for debugger only
 } BaseExceptionFrame;
 
+int BaseExceptionFrame__lineno(const BaseExceptionFrame* self);
+const char* BaseExceptionFrame__name(const BaseExceptionFrame* self);
+
 typedef struct BaseException {
     py_TValue args;
     py_TValue inner_exc;
     c11_vector /*T=BaseExceptionFrame*/ stacktrace;
 } BaseException;
-
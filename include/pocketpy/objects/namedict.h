@@ -18,11 +18,14 @@ typedef struct NameDict {
     NameDict_KV* items;
 } NameDict;
 
+uintptr_t ThomasWangInt32Hash(void* Ptr);
+
 NameDict* NameDict__new(float load_factor);
 void NameDict__delete(NameDict* self);
 void NameDict__ctor(NameDict* self, float load_factor);
 void NameDict__dtor(NameDict* self);
 py_TValue* NameDict__try_get(NameDict* self, py_Name key);
+int NameDict__index(NameDict* self, py_Name key);  // -1 if not found
 bool NameDict__contains(NameDict* self, py_Name key);
 void NameDict__set(NameDict* self, py_Name key, py_TValue* value);
 bool NameDict__del(NameDict* self, py_Name key);
@@ -2,12 +2,20 @@
 
 #include "pocketpy/objects/namedict.h"
 #include "pocketpy/objects/base.h"
+#include "pocketpy/interpreter/objectpool.h"
 
 typedef struct PyObject {
     py_Type type;  // we have a duplicated type here for convenience
-    // bool _;
-    bool gc_marked;
+    bool gc_marked;          // only for large objects, see `PyObject__is_marked`
+    bool gc_large : 1;       // not allocated from a pool
+    bool gc_remembered : 1;  // in the remembered set of the generational gc
+    bool gc_frozen : 1;      // only for large objects, see `PyObject__is_frozen`
+    bool gc_frozen_root : 1;  // frozen but written since, its children are marked as roots
     int slots;  // number of slots in the object
+#if PK_ENABLE_HEAP_PROFILER
+    int alloc_site;  // index into `HeapProfiler.sites`
+    int alloc_size;  // bytes taken from the heap, the block size for pooled objects
+#endif
     char flex[];
 } PyObject;
 
@@ -26,10 +34,67 @@ void* PyObject__userdata(PyObject* self);
 void PyObject__dtor(PyObject* self);
 
 
+// small objects are marked in the bitmap of their arena, large objects in the header
+#define PyObject__is_marked(obj)                                                                   \
+    ((obj)->gc_large ? (obj)->gc_marked                                                            \
+                     : PoolArena__bitmap_get(PoolArena__of(obj)->marks,                            \
+                                             PoolArena__granule(PoolArena__of(obj), obj)))
+
+// frozen objects stay marked, so they are neither traversed nor swept
+#define PyObject__is_frozen(obj)                                                                   \
+    ((obj)->gc_large ? (obj)->gc_frozen                                                            \
+                     : PoolArena__bitmap_get(PoolArena__of(obj)->frozen,                           \
+                                             PoolArena__granule(PoolArena__of(obj), obj)))
+
+#define PyObject__set_marked(obj)                                                                  \
+    do {                                                                                           \
+        if((obj)->gc_large) {                                                                      \
+            (obj)->gc_marked = true;                                                               \
+        } else {                                                                                   \
+            PoolArena* _arena = PoolArena__of(obj);                                                \
+            PoolArena__bitmap_set(_arena->marks, PoolArena__granule(_arena, obj));                 \
+        }                                                                                          \
+    } while(0)
+
+#if PK_ENABLE_PARALLEL_MARK
+#include <stdatomic.h>
+
+// true on the threads of a parallel mark, which must read and set mark bits atomically
+extern PK_THREAD_LOCAL bool pk__mark_atomic;
+
+// returns false if `obj` is already marked, possibly by another thread
+static inline bool PyObject__set_marked_atomic(PyObject* obj) {
+    if(obj->gc_large) {
+        _Atomic(bool)* marked = (_Atomic(bool)*)&obj->gc_marked;
+        if(atomic_load_explicit(marked, memory_order_relaxed)) return false;
+        return !atomic_exchange_explicit(marked, true, memory_order_relaxed);
+    }
+    PoolArena* arena = PoolArena__of(obj);
+    int i = PoolArena__granule(arena, obj);
+    uint64_t bit = (uint64_t)1 << (i & 63);
+    _Atomic(uint64_t)* word = (_Atomic(uint64_t)*)&arena->marks[i >> 6];
+    if(atomic_load_explicit(word, memory_order_relaxed) & bit) return false;
+    return !(atomic_fetch_or_explicit(word, bit, memory_order_relaxed) & bit);
+}
+
+#define pk__mark_value(val)                                                                        \
+    if((val)->is_ptr) {                                                                            \
+        PyObject* obj = (val)->_obj;                                                               \
+        if(!pk__mark_atomic) {                                                                     \
+            if(!PyObject__is_marked(obj)) {                                                        \
+                PyObject__set_marked(obj);                                                         \
+                c11_vector__push(PyObject*, p_stack, obj);                                         \
+            }                                                                                      \
+        } else if(PyObject__set_marked_atomic(obj)) {                                              \
+            c11_vector__push(PyObject*, p_stack, obj);                                             \
+        }                                                                                          \
+    }
+#else
 #define pk__mark_value(val)                                                                        \
-    if((val)->is_ptr && !(val)->_obj->gc_marked) {                                                 \
+    if((val)->is_ptr && !PyObject__is_marked((val)->_obj)) {                                       \
         PyObject* obj = (val)->_obj;                                                               \
-        obj->gc_marked = true;                                                                     \
+        PyObject__set_marked(obj);                                                                 \
         c11_vector__push(PyObject*, p_stack, obj);                                                 \
     }
+#endif
 
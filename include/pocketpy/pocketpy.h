@@ -36,7 +36,7 @@ typedef struct py_TValue {
 
     union {
         int64_t _i64;
-        char _chars[16];
+        char _chars[PK_TVALUE_PAYLOAD_SIZE];
     };
 } py_TValue;
 #endif
@@ -129,6 +129,20 @@ PK_API void py_sys_setargv(int argc, char** argv);
 PK_API void py_sys_settrace(py_TraceFunc func, bool reset);
 /// Invoke the garbage collector.
 PK_API int py_gc_collect();
+/// Do a slice of garbage collection work for at most `budget_us` microseconds.
+/// Returns `true` if no collection is in progress afterwards.
+PK_API bool py_gc_step(int budget_us);
+/// Move all live objects into a permanent generation that is ignored by future collections.
+PK_API void py_gc_freeze();
+/// Move all objects of the permanent generation back into the collected heap.
+PK_API void py_gc_unfreeze();
+/// Count the live objects and their bytes by type and by allocating source line.
+/// The result is `{"types": {type: row}, "sites": {(filename, lineno): row}}`,
+/// where each row is `(count, bytes, allocated)` and `allocated` counts all objects ever created.
+/// If `since` is not `NULL`, it must be a previous result and only the changed rows are returned.
+/// `PK_ENABLE_HEAP_PROFILER` must be defined to `1` to use this feature,
+/// otherwise `NotImplementedError` is raised.
+PK_API bool py_heap_census(py_Ref since) PY_RAISE PY_RETURN;
 /// Setup the callbacks for the current VM.
 PK_API py_Callbacks* py_callbacks();
 
@@ -143,7 +157,15 @@ PK_API void py_free(void* ptr);
 /// `PK_ENABLE_WATCHDOG` must be defined to `1` to use this feature.
 /// You need to call `py_watchdog_end()` later.
 /// If `timeout` is reached, `TimeoutError` will be raised.
+/// The clock is polled every `PK_WATCHDOG_CLOCK_INTERVAL` fuel units, see `py_watchdog_begin_fuel()`.
 PK_API void py_watchdog_begin(py_i64 timeout);
+/// Begin the watchdog with a deterministic budget of `fuel` units.
+/// Each backward jump burns as many units as the instructions it jumps over,
+/// and each frame switch burns one unit.
+/// `PK_ENABLE_WATCHDOG` must be defined to `1` to use this feature.
+/// You need to call `py_watchdog_end()` later.
+/// If the budget runs out, `TimeoutError` will be raised.
+PK_API void py_watchdog_begin_fuel(py_i64 fuel);
 /// Reset the watchdog.
 PK_API void py_watchdog_end();
 
@@ -216,7 +238,7 @@ PK_API py_GlobalRef py_NIL();
 
 /// Create an `int` object.
 PK_API void py_newint(py_OutRef, py_i64);
-/// Create a trivial value object.
+/// Create a trivial value object. `size` must not exceed `PK_TVALUE_PAYLOAD_SIZE`.
 PK_API void py_newtrivial(py_OutRef out, py_Type type, void* data, int size);
 /// Create a `float` object.
 PK_API void py_newfloat(py_OutRef, py_f64);
@@ -440,6 +462,8 @@ PK_API void py_cleardict(py_Ref self);
 
 /// Get the i-th slot of the object.
 /// The object must have slots and `i` must be in valid range.
+/// Writes through the returned pointer are not seen by the generational gc,
+/// use `py_setslot` unless the object is new or still on the value stack.
 PK_API py_ObjectRef py_getslot(py_Ref self, int i);
 /// Set the i-th slot of the object.
 PK_API void py_setslot(py_Ref self, int i, py_Ref val);
@@ -879,6 +903,12 @@ enum py_PredefinedType {
     tp_array2d,
     tp_array2d_view,
     tp_chunked_array2d,
+    /* unboxed `for` loop states, only found in the iterator slot of the value stack */
+    tp_for_range,  // extra=step, [current, stop]
+    tp_for_list,   // list + extra=index
+    tp_for_tuple,  // tuple + extra=index
+    tp_for_str,    // str + extra=byte offset
+    tp_for_dict,   // dict + extra=entry index, [_, version]
 };
 
 #ifdef __cplusplus
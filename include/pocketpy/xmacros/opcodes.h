@@ -24,6 +24,7 @@ OPCODE(LOAD_NULL)
 OPCODE(LOAD_FAST)
 OPCODE(LOAD_NAME)
 OPCODE(LOAD_NONLOCAL)
+OPCODE(LOAD_CLOSURE)
 OPCODE(LOAD_GLOBAL)
 OPCODE(LOAD_ATTR)
 OPCODE(LOAD_CLASS_GLOBAL)
@@ -116,7 +117,6 @@ OPCODE(ADD_CLASS_ANNOTATION)
 OPCODE(WITH_ENTER)
 OPCODE(WITH_EXIT)
 /**************************/
-OPCODE(TRY_ENTER)
 OPCODE(EXCEPTION_MATCH)
 OPCODE(RAISE)
 OPCODE(RAISE_ASSERT)
@@ -129,4 +129,46 @@ OPCODE(END_FINALLY)
 /**************************/
 OPCODE(FORMAT_STRING)
 /**************************/
+// specialized variants written by quickening, never emitted by the compiler
+OPCODE(BINARY_ADD_INT)
+OPCODE(BINARY_SUB_INT)
+OPCODE(BINARY_MUL_INT)
+OPCODE(BINARY_FLOORDIV_INT)
+OPCODE(BINARY_MOD_INT)
+OPCODE(COMPARE_LT_INT)
+OPCODE(COMPARE_LE_INT)
+OPCODE(COMPARE_EQ_INT)
+OPCODE(COMPARE_NE_INT)
+OPCODE(COMPARE_GT_INT)
+OPCODE(COMPARE_GE_INT)
+OPCODE(BINARY_ADD_FLOAT)
+OPCODE(BINARY_SUB_FLOAT)
+OPCODE(BINARY_MUL_FLOAT)
+OPCODE(BINARY_TRUEDIV_FLOAT)
+OPCODE(COMPARE_LT_FLOAT)
+OPCODE(COMPARE_LE_FLOAT)
+OPCODE(COMPARE_EQ_FLOAT)
+OPCODE(COMPARE_NE_FLOAT)
+OPCODE(COMPARE_GT_FLOAT)
+OPCODE(COMPARE_GE_FLOAT)
+OPCODE(FOR_ITER_RANGE)
+OPCODE(FOR_ITER_LIST)
+OPCODE(FOR_ITER_TUPLE)
+OPCODE(FOR_ITER_STR)
+OPCODE(FOR_ITER_DICT)
+/**************************/
+// superinstructions written by the compiler's peephole pass
+// they replace the first opcode of a sequence and leave the rest in place
+OPCODE(LOAD_FAST__LOAD_FAST)
+OPCODE(LOAD_FAST__LOAD_SMALL_INT)
+OPCODE(LOAD_FAST__LOAD_SMALL_INT__BINARY_ADD)
+OPCODE(LOAD_FAST__LOAD_SMALL_INT__BINARY_SUB)
+OPCODE(STORE_FAST__LOAD_FAST)
+OPCODE(COMPARE_LT__POP_JUMP_IF_FALSE)
+OPCODE(COMPARE_LE__POP_JUMP_IF_FALSE)
+OPCODE(COMPARE_EQ__POP_JUMP_IF_FALSE)
+OPCODE(COMPARE_NE__POP_JUMP_IF_FALSE)
+OPCODE(COMPARE_GT__POP_JUMP_IF_FALSE)
+OPCODE(COMPARE_GE__POP_JUMP_IF_FALSE)
+/**************************/
 #endif
@@ -34,9 +34,39 @@ def watchdog_begin(timeout: int):
     You need to call `watchdog_end()` later.
     If `timeout` is reached, `TimeoutError` will be raised.
     """
+def watchdog_begin_fuel(fuel: int):
+    """Begin the watchdog with a deterministic budget of `fuel` units.
+
+    Each backward jump burns as many units as the instructions it jumps over,
+    and each frame switch burns one unit. Unlike `watchdog_begin()`, the cutoff
+    point is reproducible across runs and machines.
+    `PK_ENABLE_WATCHDOG` must be defined to `1` to use this feature.
+    You need to call `watchdog_end()` later.
+    If the budget runs out, `TimeoutError` will be raised.
+    """
 def watchdog_end() -> None:
     """End the watchdog after a call to `watchdog_begin()`."""
 
+def opcode_pairs() -> list[tuple[str, str, int]]:
+    """Return `(prev, next, count)` for every pair of opcodes executed back to back.
+
+    `PK_ENABLE_OPCODE_STATS` must be defined to `1` to use this feature.
+    See `scripts/mine_opcode_pairs.py`.
+    """
+
+def heap_census(since: dict | None = None) -> dict:
+    """Count the live objects and their bytes by type and by allocating source line.
+
+    A full collection is done first. The result looks like
+    `{"types": {type: row}, "sites": {(filename, lineno): row}}`, where each row is
+    `(count, bytes, allocated)` and `allocated` counts all objects ever created there.
+    Objects created without a python frame are attributed to `("<native>", 0)`.
+
+    If `since` is a previous result, only the changed rows are returned, as differences.
+    A growing `count` points to a leak, a large `allocated` with a flat `count` to churn.
+    `PK_ENABLE_HEAP_PROFILER` must be defined to `1` to use this feature.
+    """
+
 def profiler_begin() -> None: ...
 def profiler_end() -> None: ...
 def profiler_reset() -> None: ...
@@ -0,0 +1,66 @@
+# Mine the most frequently executed opcode pairs, used to pick superinstructions.
+#
+# Build with `-DPK_ENABLE_OPCODE_STATS=ON` first, then run:
+#   python scripts/mine_opcode_pairs.py <path/to/main> benchmarks/*.py tests/*.py
+#
+# Superinstructions are disabled in this build mode, so the counts reflect the
+# unfused bytecode emitted by the compiler.
+
+import os
+import sys
+import subprocess
+import tempfile
+from collections import Counter
+
+DRIVER = '''
+import pkpy
+
+def __snapshot():
+    return {(a, b): n for a, b, n in pkpy.opcode_pairs()}
+
+__before = __snapshot()
+exec(compile(open(%r, 'r').read(), %r, 'exec'))
+for __k, __n in __snapshot().items():
+    __n -= __before.get(__k, 0)
+    if __n > 0:
+        print('@@', __k[0], __k[1], __n)
+'''
+
+
+def mine(main, path):
+    with tempfile.NamedTemporaryFile('w', suffix='.py', delete=False) as f:
+        f.write(DRIVER % (path, path))
+        driver = f.name
+    try:
+        res = subprocess.run([main, driver], capture_output=True, text=True)
+    finally:
+        os.remove(driver)
+    counts = Counter()
+    for line in res.stdout.splitlines():
+        if line.startswith('@@ '):
+            _, a, b, n = line.split()
+            counts[(a, b)] += int(n)
+    if res.returncode != 0:
+        print(f'warning: {path} exited with code {res.returncode}', file=sys.stderr)
+    return counts
+
+
+def main():
+    if len(sys.argv) < 3:
+        print('usage: python scripts/mine_opcode_pairs.py <main> <script.py>...')
+        exit(1)
+    total = Counter()
+    for path in sys.argv[2:]:
+        counts = mine(sys.argv[1], path)
+        # normalize per script so that long-running benchmarks do not dominate
+        n = sum(counts.values())
+        for k, v in counts.items():
+            total[k] += v / n
+    n = sum(total.values())
+    print(f'{"prev":<24}{"next":<24}{"share":>8}')
+    for (a, b), v in total.most_common(40):
+        print(f'{a:<24}{b:<24}{v / n:>8.2%}')
+
+
+if __name__ == '__main__':
+    main()
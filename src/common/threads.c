@@ -2,6 +2,25 @@
 
 #if PK_ENABLE_THREADS
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+int c11_thrd_processor_count() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#else
+    return 1;
+#endif
+}
+
 #if PK_USE_PTHREADS
 
 bool c11_thrd_create(c11_thrd_t* thrd, c11_thrd_retval_t (*func)(void*), void* arg) {
@@ -9,8 +28,26 @@ bool c11_thrd_create(c11_thrd_t* thrd, c11_thrd_retval_t (*func)(void*), void* a
     return res == 0;
 }
 
+void c11_thrd_join(c11_thrd_t thrd) { pthread_join(thrd, NULL); }
+
 void c11_thrd_yield() { sched_yield(); }
 
+void c11_mtx_init(c11_mtx_t* mtx) { pthread_mutex_init(mtx, NULL); }
+
+void c11_mtx_destroy(c11_mtx_t* mtx) { pthread_mutex_destroy(mtx); }
+
+void c11_mtx_lock(c11_mtx_t* mtx) { pthread_mutex_lock(mtx); }
+
+void c11_mtx_unlock(c11_mtx_t* mtx) { pthread_mutex_unlock(mtx); }
+
+void c11_cnd_init(c11_cnd_t* cnd) { pthread_cond_init(cnd, NULL); }
+
+void c11_cnd_destroy(c11_cnd_t* cnd) { pthread_cond_destroy(cnd); }
+
+void c11_cnd_wait(c11_cnd_t* cnd, c11_mtx_t* mtx) { pthread_cond_wait(cnd, mtx); }
+
+void c11_cnd_broadcast(c11_cnd_t* cnd) { pthread_cond_broadcast(cnd); }
+
 #else
 
 bool c11_thrd_create(c11_thrd_t* thrd, c11_thrd_retval_t (*func)(void*), void* arg) {
@@ -18,8 +55,26 @@ bool c11_thrd_create(c11_thrd_t* thrd, c11_thrd_retval_t (*func)(void*), void* a
     return res == thrd_success;
 }
 
+void c11_thrd_join(c11_thrd_t thrd) { thrd_join(thrd, NULL); }
+
 void c11_thrd_yield() { thrd_yield(); }
 
+void c11_mtx_init(c11_mtx_t* mtx) { mtx_init(mtx, mtx_plain); }
+
+void c11_mtx_destroy(c11_mtx_t* mtx) { mtx_destroy(mtx); }
+
+void c11_mtx_lock(c11_mtx_t* mtx) { mtx_lock(mtx); }
+
+void c11_mtx_unlock(c11_mtx_t* mtx) { mtx_unlock(mtx); }
+
+void c11_cnd_init(c11_cnd_t* cnd) { cnd_init(cnd); }
+
+void c11_cnd_destroy(c11_cnd_t* cnd) { cnd_destroy(cnd); }
+
+void c11_cnd_wait(c11_cnd_t* cnd, c11_mtx_t* mtx) { cnd_wait(cnd, mtx); }
+
+void c11_cnd_broadcast(c11_cnd_t* cnd) { cnd_broadcast(cnd); }
+
 #endif
 
 #endif  // PK_ENABLE_THREADS
\ No newline at end of file
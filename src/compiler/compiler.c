@@ -20,6 +20,8 @@ typedef struct ExprVt {
     bool (*emit_store)(Expr*, Ctx*);
     void (*emit_inplace)(Expr*, Ctx*);
     bool (*emit_istore)(Expr*, Ctx*);
+    /* constant folding */
+    bool (*fold)(Expr*, py_OutRef);
     /* reflections */
     bool is_literal;
     bool is_name;     // NameExpr
@@ -36,6 +38,7 @@ typedef struct ExprVt {
 #define vtemit_(self, ctx) vtcall(emit_, (self), (ctx))
 #define vtemit_del(self, ctx) ((self)->vt->emit_del ? vtcall(emit_del, self, ctx) : false)
 #define vtemit_store(self, ctx) ((self)->vt->emit_store ? vtcall(emit_store, self, ctx) : false)
+#define vtfold(self, out) ((self)->vt->fold ? (self)->vt->fold((self), (out)) : false)
 #define vtemit_inplace(self, ctx)                                                                  \
     ((self)->vt->emit_inplace ? vtcall(emit_inplace, self, ctx) : vtemit_(self, ctx))
 #define vtemit_istore(self, ctx)                                                                   \
@@ -84,6 +87,7 @@ static int Ctx__add_varname(Ctx* self, py_Name name);
 static int Ctx__add_name(Ctx* self, py_Name name);
 static int Ctx__add_const(Ctx* self, py_Ref);
 static int Ctx__add_const_string(Ctx* self, c11_sv);
+static void Ctx__emit_const(Ctx* self, py_Ref value, int line);
 static void Ctx__emit_store_name(Ctx* self, NameScope scope, py_Name name, int line);
 static void Ctx__s_emit_top(Ctx*);     // emit top -> pop -> delete
 static void Ctx__s_push(Ctx*, Expr*);  // push
@@ -212,14 +216,45 @@ void UnaryExpr__dtor(Expr* self_) {
     vtdelete(self->child);
 }
 
+static bool UnaryExpr__fold(Expr* self_, py_OutRef out) {
+    UnaryExpr* self = (UnaryExpr*)self_;
+    py_TValue value;
+    if(!vtfold(self->child, &value)) return false;
+    switch(self->opcode) {
+        case OP_UNARY_NOT: py_newbool(out, !py_bool(&value)); return true;
+        case OP_UNARY_NEGATIVE:
+            if(value.type == tp_int) {
+                py_newint(out, -py_toint(&value));
+                return true;
+            }
+            if(value.type == tp_float) {
+                py_newfloat(out, -py_tofloat(&value));
+                return true;
+            }
+            return false;
+        case OP_UNARY_INVERT:
+            if(value.type != tp_int) return false;
+            py_newint(out, ~py_toint(&value));
+            return true;
+        default: return false;
+    }
+}
+
 static void UnaryExpr__emit_(Expr* self_, Ctx* ctx) {
     UnaryExpr* self = (UnaryExpr*)self_;
+    py_TValue value;
+    if(UnaryExpr__fold(self_, &value)) {
+        Ctx__emit_const(ctx, &value, self->line);
+        return;
+    }
     vtemit_(self->child, ctx);
     Ctx__emit_(ctx, self->opcode, BC_NOARG, self->line);
 }
 
 UnaryExpr* UnaryExpr__new(int line, Expr* child, Opcode opcode) {
-    const static ExprVt Vt = {.emit_ = UnaryExpr__emit_, .dtor = UnaryExpr__dtor};
+    const static ExprVt Vt = {.emit_ = UnaryExpr__emit_,
+                              .fold = UnaryExpr__fold,
+                              .dtor = UnaryExpr__dtor};
     UnaryExpr* self = PK_MALLOC(sizeof(UnaryExpr));
     self->vt = &Vt;
     self->line = line;
@@ -331,8 +366,31 @@ void LiteralExpr__emit_(Expr* self_, Ctx* ctx) {
     }
 }
 
+bool LiteralExpr__fold(Expr* self_, py_OutRef out) {
+    LiteralExpr* self = (LiteralExpr*)self_;
+    switch(self->value->index) {
+        case TokenValue_I64: {
+            py_i64 val = self->value->_i64;
+            py_newint(out, self->negated ? -val : val);
+            return true;
+        }
+        case TokenValue_F64: {
+            py_f64 val = self->value->_f64;
+            py_newfloat(out, self->negated ? -val : val);
+            return true;
+        }
+        case TokenValue_STR: {
+            py_newstrv(out, c11_string__sv(self->value->_str));
+            return true;
+        }
+        default: return false;
+    }
+}
+
 LiteralExpr* LiteralExpr__new(int line, const TokenValue* value) {
-    const static ExprVt Vt = {.emit_ = LiteralExpr__emit_, .is_literal = true};
+    const static ExprVt Vt = {.emit_ = LiteralExpr__emit_,
+                              .fold = LiteralExpr__fold,
+                              .is_literal = true};
     LiteralExpr* self = PK_MALLOC(sizeof(LiteralExpr));
     self->vt = &Vt;
     self->line = line;
@@ -359,8 +417,20 @@ void Literal0Expr__emit_(Expr* self_, Ctx* ctx) {
     Ctx__emit_(ctx, opcode, BC_NOARG, self->line);
 }
 
+bool Literal0Expr__fold(Expr* self_, py_OutRef out) {
+    Literal0Expr* self = (Literal0Expr*)self_;
+    switch(self->token) {
+        case TK_NONE: py_newnone(out); break;
+        case TK_TRUE: py_newbool(out, true); break;
+        case TK_FALSE: py_newbool(out, false); break;
+        case TK_DOTDOTDOT: py_newellipsis(out); break;
+        default: c11__unreachable();
+    }
+    return true;
+}
+
 Literal0Expr* Literal0Expr__new(int line, TokenIndex token) {
-    const static ExprVt Vt = {.emit_ = Literal0Expr__emit_};
+    const static ExprVt Vt = {.emit_ = Literal0Expr__emit_, .fold = Literal0Expr__fold};
     Literal0Expr* self = PK_MALLOC(sizeof(Literal0Expr));
     self->vt = &Vt;
     self->line = line;
@@ -467,6 +537,11 @@ typedef struct SequenceExpr {
 
 static void SequenceExpr__emit_(Expr* self_, Ctx* ctx) {
     SequenceExpr* self = (SequenceExpr*)self_;
+    py_TValue value;
+    if(vtfold(self_, &value)) {
+        Ctx__emit_const(ctx, &value, self->line);
+        return;
+    }
     for(int i = 0; i < self->itemCount; i++) {
         Expr* item = self->items[i];
         vtemit_(item, ctx);
@@ -562,8 +637,18 @@ SequenceExpr* SetExpr__new(int line, int count) {
     return SequenceExpr__new(line, &SetExprVt, count, OP_BUILD_SET);
 }
 
+bool TupleExpr__fold(Expr* self_, py_OutRef out) {
+    SequenceExpr* self = (SequenceExpr*)self_;
+    py_TValue* data = py_newtuple(out, self->itemCount);
+    for(int i = 0; i < self->itemCount; i++) {
+        if(!vtfold(self->items[i], &data[i])) return false;
+    }
+    return true;
+}
+
 SequenceExpr* TupleExpr__new(int line, int count) {
     const static ExprVt TupleExprVt = {.dtor = SequenceExpr__dtor,
+                                       .fold = TupleExpr__fold,
                                        .emit_ = SequenceExpr__emit_,
                                        .is_tuple = true,
                                        .emit_store = TupleExpr__emit_store,
@@ -661,8 +746,23 @@ void LogicBinaryExpr__dtor(Expr* self_) {
     vtdelete(self->rhs);
 }
 
+bool LogicBinaryExpr__fold(Expr* self_, py_OutRef out) {
+    LogicBinaryExpr* self = (LogicBinaryExpr*)self_;
+    py_TValue lhs, rhs;
+    if(!vtfold(self->lhs, &lhs) || !vtfold(self->rhs, &rhs)) return false;
+    // `a or b` keeps `a` if it is truthy, `a and b` keeps `a` if it is falsy
+    bool keep_lhs = py_bool(&lhs) == (self->opcode == OP_JUMP_IF_TRUE_OR_POP);
+    *out = keep_lhs ? lhs : rhs;
+    return true;
+}
+
 void LogicBinaryExpr__emit_(Expr* self_, Ctx* ctx) {
     LogicBinaryExpr* self = (LogicBinaryExpr*)self_;
+    py_TValue value;
+    if(LogicBinaryExpr__fold(self_, &value)) {
+        Ctx__emit_const(ctx, &value, self->line);
+        return;
+    }
     vtemit_(self->lhs, ctx);
     int patch = Ctx__emit_(ctx, self->opcode, BC_NOARG, self->line);
     vtemit_(self->rhs, ctx);
@@ -670,7 +770,9 @@ void LogicBinaryExpr__emit_(Expr* self_, Ctx* ctx) {
 }
 
 LogicBinaryExpr* LogicBinaryExpr__new(int line, Opcode opcode) {
-    const static ExprVt Vt = {.emit_ = LogicBinaryExpr__emit_, .dtor = LogicBinaryExpr__dtor};
+    const static ExprVt Vt = {.emit_ = LogicBinaryExpr__emit_,
+                              .fold = LogicBinaryExpr__fold,
+                              .dtor = LogicBinaryExpr__dtor};
     LogicBinaryExpr* self = PK_MALLOC(sizeof(LogicBinaryExpr));
     self->vt = &Vt;
     self->line = line;
@@ -695,6 +797,11 @@ void GroupedExpr__emit_(Expr* self_, Ctx* ctx) {
     vtemit_(self->child, ctx);
 }
 
+bool GroupedExpr__fold(Expr* self_, py_OutRef out) {
+    GroupedExpr* self = (GroupedExpr*)self_;
+    return vtfold(self->child, out);
+}
+
 bool GroupedExpr__emit_del(Expr* self_, Ctx* ctx) {
     GroupedExpr* self = (GroupedExpr*)self_;
     return vtemit_del(self->child, ctx);
@@ -708,6 +815,7 @@ bool GroupedExpr__emit_store(Expr* self_, Ctx* ctx) {
 GroupedExpr* GroupedExpr__new(int line, Expr* child) {
     const static ExprVt Vt = {.dtor = GroupedExpr__dtor,
                               .emit_ = GroupedExpr__emit_,
+                              .fold = GroupedExpr__fold,
                               .emit_del = GroupedExpr__emit_del,
                               .emit_store = GroupedExpr__emit_store};
     GroupedExpr* self = PK_MALLOC(sizeof(GroupedExpr));
@@ -760,8 +868,109 @@ static void _emit_compare(BinaryExpr* self, Ctx* ctx, c11_vector* jmps) {
     c11_vector__push(int, jmps, index);
 }
 
+// folded strings longer than this stay as runtime operations to keep `consts` small
+#define FOLD_MAX_STR_LENGTH 4096
+
+static bool is_fold_number(py_Ref v) { return v->type == tp_int || v->type == tp_float; }
+
+static bool is_fold_zero(py_Ref v) {
+    return v->type == tp_int ? py_toint(v) == 0 : py_tofloat(v) == 0.0;
+}
+
+static bool BinaryExpr__fold(Expr* self_, py_OutRef out) {
+    BinaryExpr* self = (BinaryExpr*)self_;
+    // `a < b < c` is not `(a < b) < c`
+    if(self->inplace || (cmp_token2op(self->op) && is_compare_expr(self->lhs))) return false;
+    py_TValue lhs, rhs;
+    if(!vtfold(self->lhs, &lhs) || !vtfold(self->rhs, &rhs)) return false;
+    // only fold operands whose builtin operators cannot raise
+    bool num = is_fold_number(&lhs) && is_fold_number(&rhs);
+    bool str = lhs.type == tp_str && rhs.type == tp_str;
+    bool i64 = lhs.type == tp_int && rhs.type == tp_int;
+    py_Name op = 0, rop = 0;
+    switch(self->op) {
+        case TK_ADD:
+            if(str) {
+                if(py_tosv(&lhs).size + py_tosv(&rhs).size > FOLD_MAX_STR_LENGTH) return false;
+            } else if(!num) {
+                return false;
+            }
+            op = __add__, rop = __radd__;
+            break;
+        case TK_SUB:
+            if(!num) return false;
+            op = __sub__, rop = __rsub__;
+            break;
+        case TK_MUL:
+            if(lhs.type == tp_str && rhs.type == tp_int) {
+                py_i64 n = py_toint(&rhs);
+                if(n > 0 && py_tosv(&lhs).size > FOLD_MAX_STR_LENGTH / n) return false;
+            } else if(!num) {
+                return false;
+            }
+            op = __mul__, rop = __rmul__;
+            break;
+        case TK_DIV:
+        case TK_FLOORDIV:
+        case TK_MOD:
+            if(!num || is_fold_zero(&rhs)) return false;
+            if(i64 && py_toint(&lhs) == INT64_MIN) return false;
+            // `//` is not defined for floats, leave the error to runtime
+            if(self->op == TK_FLOORDIV && !i64) return false;
+            if(self->op == TK_DIV) op = __truediv__, rop = __rtruediv__;
+            if(self->op == TK_FLOORDIV) op = __floordiv__, rop = __rfloordiv__;
+            if(self->op == TK_MOD) op = __mod__, rop = __rmod__;
+            break;
+        case TK_POW:
+            if(!num) return false;
+            // 0 ** -1 raises ZeroDivisionError
+            if(i64 && py_toint(&lhs) == 0 && py_toint(&rhs) < 0) return false;
+            op = __pow__, rop = __rpow__;
+            break;
+        case TK_LT: op = __lt__, rop = __gt__; goto __COMPARE;
+        case TK_LE: op = __le__, rop = __ge__; goto __COMPARE;
+        case TK_GT: op = __gt__, rop = __lt__; goto __COMPARE;
+        case TK_GE: op = __ge__, rop = __le__; goto __COMPARE;
+        case TK_EQ: op = __eq__, rop = __eq__; goto __COMPARE;
+        case TK_NE: op = __ne__, rop = __ne__; goto __COMPARE;
+        __COMPARE:
+            if(!num && !str) return false;
+            break;
+        case TK_LSHIFT:
+        case TK_RSHIFT:
+            if(!i64 || py_toint(&lhs) < 0) return false;
+            if(py_toint(&rhs) < 0 || py_toint(&rhs) >= 64) return false;
+            op = self->op == TK_LSHIFT ? __lshift__ : __rshift__;
+            break;
+        case TK_AND: op = __and__; goto __BITWISE;
+        case TK_OR: op = __or__; goto __BITWISE;
+        case TK_XOR: op = __xor__; goto __BITWISE;
+        __BITWISE:
+            if(!i64) return false;
+            break;
+        default: return false;
+    }
+    // evaluate with the same builtin operators the VM would run
+    py_TValue retval = *py_retval();
+    py_StackRef p0 = py_peek(0);
+    bool ok = py_binaryop(&lhs, &rhs, op, rop);
+    // an unsupported case is not folded, it raises at runtime instead
+    if(ok) {
+        *out = *py_retval();
+    } else {
+        py_clearexc(p0);
+    }
+    *py_retval() = retval;
+    return ok;
+}
+
 static void BinaryExpr__emit_(Expr* self_, Ctx* ctx) {
     BinaryExpr* self = (BinaryExpr*)self_;
+    py_TValue value;
+    if(BinaryExpr__fold(self_, &value)) {
+        Ctx__emit_const(ctx, &value, self->line);
+        return;
+    }
     c11_vector /*T=int*/ jmps;
     c11_vector__ctor(&jmps, sizeof(int));
     if(cmp_token2op(self->op) && is_compare_expr(self->lhs)) {
@@ -835,6 +1044,7 @@ static void BinaryExpr__emit_(Expr* self_, Ctx* ctx) {
 
 BinaryExpr* BinaryExpr__new(int line, TokenIndex op, bool inplace) {
     const static ExprVt Vt = {.emit_ = BinaryExpr__emit_,
+                              .fold = BinaryExpr__fold,
                               .dtor = BinaryExpr__dtor,
                               .is_binary = true};
     BinaryExpr* self = PK_MALLOC(sizeof(BinaryExpr));
@@ -1154,6 +1364,19 @@ static int Ctx__enter_block(Ctx* self, CodeBlockType type) {
     return self->curr_iblock;
 }
 
+// number of values kept on the stack by the blocks enclosing the current one
+static int Ctx__stack_depth(Ctx* self) {
+    int depth = self->is_compiling_class ? 1 : 0;  // the class object pushed by BEGIN_CLASS
+    int index = self->curr_iblock;
+    while(index >= 0) {
+        CodeBlock* block = c11__at(CodeBlock, &self->co->blocks, index);
+        // the iterator of a for loop or the context manager of a with block
+        if(block->type == CodeBlockType_FOR_LOOP || block->type == CodeBlockType_WITH) depth++;
+        index = block->parent;
+    }
+    return depth;
+}
+
 static void Ctx__exit_block(Ctx* self) {
     CodeBlock* block = c11__at(CodeBlock, &self->co->blocks, self->curr_iblock);
     block->end = self->co->codes.length;
@@ -1178,7 +1401,7 @@ static void Ctx__s_emit_decorators(Ctx* self, int count) {
 
 static int Ctx__emit_(Ctx* self, Opcode opcode, uint16_t arg, int line) {
     Bytecode bc = {(uint8_t)opcode, arg};
-    BytecodeEx bcx = {line, self->curr_iblock};
+    BytecodeEx bcx = {line, self->curr_iblock, -1};
     c11_vector__push(Bytecode, &self->co->codes, bc);
     c11_vector__push(BytecodeEx, &self->co->codes_ex, bcx);
     int i = self->co->codes.length - 1;
@@ -1253,6 +1476,21 @@ static int Ctx__add_const(Ctx* self, py_Ref v) {
     return self->co->consts.length - 1;
 }
 
+static void Ctx__emit_const(Ctx* self, py_Ref value, int line) {
+    switch(value->type) {
+        case tp_NoneType: Ctx__emit_(self, OP_LOAD_NONE, BC_NOARG, line); break;
+        case tp_bool:
+            Ctx__emit_(self, py_tobool(value) ? OP_LOAD_TRUE : OP_LOAD_FALSE, BC_NOARG, line);
+            break;
+        case tp_ellipsis: Ctx__emit_(self, OP_LOAD_ELLIPSIS, BC_NOARG, line); break;
+        case tp_int: Ctx__emit_int(self, py_toint(value), line); break;
+        case tp_str:
+            Ctx__emit_(self, OP_LOAD_CONST, Ctx__add_const_string(self, py_tosv(value)), line);
+            break;
+        default: Ctx__emit_(self, OP_LOAD_CONST, Ctx__add_const(self, value), line); break;
+    }
+}
+
 static void Ctx__emit_store_name(Ctx* self, NameScope scope, py_Name name, int line) {
     switch(scope) {
         case NAME_LOCAL: Ctx__emit_(self, OP_STORE_FAST, Ctx__add_varname(self, name), line); break;
@@ -1502,6 +1740,128 @@ static void push_global_context(Compiler* self, CodeObject* co) {
     Ctx__ctor(ctx, co, NULL, self->contexts.length);
 }
 
+#if !PK_ENABLE_OPCODE_STATS
+// whether `codes[i:i+n]` can be executed as one superinstruction
+static bool can_fuse(CodeObject* co, int i, int n) {
+    if(i + n > co->codes.length) return false;
+    BytecodeEx* codes_ex = co->codes_ex.data;
+    for(int j = i + 1; j < i + n; j++) {
+        // keep line events and exception blocks exact
+        if(codes_ex[j].lineno != codes_ex[i].lineno) return false;
+        if(codes_ex[j].iblock != codes_ex[i].iblock) return false;
+    }
+    return true;
+}
+
+// Rewrite the head of common opcode sequences into superinstructions.
+// The rest of a sequence is left in place, so jump targets, `codes_ex` and inline caches
+// stay valid, and a jump into the middle of a sequence still runs the original opcodes.
+// The set is chosen by `scripts/mine_opcode_pairs.py`.
+static void fuse_superinstructions(CodeObject* co) {
+    Bytecode* codes = co->codes.data;
+    for(int i = 0; i < co->codes.length; i++) {
+        if(!can_fuse(co, i, 2)) continue;
+        Opcode op = codes[i].op;
+        Opcode next = codes[i + 1].op;
+        switch(op) {
+            case OP_LOAD_FAST: {
+                if(next == OP_LOAD_FAST) {
+                    op = OP_LOAD_FAST__LOAD_FAST;
+                } else if(next == OP_LOAD_SMALL_INT) {
+                    op = OP_LOAD_FAST__LOAD_SMALL_INT;
+                    if(can_fuse(co, i, 3)) {
+                        if(codes[i + 2].op == OP_BINARY_ADD) {
+                            op = OP_LOAD_FAST__LOAD_SMALL_INT__BINARY_ADD;
+                        } else if(codes[i + 2].op == OP_BINARY_SUB) {
+                            op = OP_LOAD_FAST__LOAD_SMALL_INT__BINARY_SUB;
+                        }
+                    }
+                }
+                break;
+            }
+            case OP_STORE_FAST: {
+                if(next == OP_LOAD_FAST) op = OP_STORE_FAST__LOAD_FAST;
+                break;
+            }
+            case OP_COMPARE_LT:
+            case OP_COMPARE_LE:
+            case OP_COMPARE_EQ:
+            case OP_COMPARE_NE:
+            case OP_COMPARE_GT:
+            case OP_COMPARE_GE: {
+                if(next != OP_POP_JUMP_IF_FALSE) break;
+                // both groups are declared in the same order in opcodes.h
+                op = OP_COMPARE_LT__POP_JUMP_IF_FALSE + (op - OP_COMPARE_LT);
+                break;
+            }
+            default: break;
+        }
+        codes[i].op = op;
+    }
+}
+#endif
+
+static int FuncDecl__capture_slot(FuncDecl* self, py_Name name) {
+    for(int i = 0; i < self->captures.length; i++) {
+        if(c11__at(FuncDeclCapture, &self->captures, i)->name == name) return i;
+    }
+    FuncDeclCapture* capture = c11_vector__emplace(&self->captures);
+    capture->name = name;
+    capture->kind = CaptureKind_UNBOUND;
+    capture->index = -1;
+    return self->captures.length - 1;
+}
+
+// find where `decl`, nested in `func` of code `co`, takes variable `name` from
+static CaptureKind
+    resolve_capture(CodeObject* co, FuncDecl* func, FuncDecl* decl, py_Name name, int* index) {
+    *index = -1;
+    if(name == py_name(decl->code.name->data)) return CaptureKind_SELF;
+    *index = c11_smallmap_n2d__get(&co->varnames_inv, name, -1);
+    if(*index >= 0) return CaptureKind_LOCAL;
+    if(func && func->nested) {
+        // forward it through a closure slot of `func`, resolved when `func` is
+        *index = FuncDecl__capture_slot(func, name);
+        return CaptureKind_CLOSURE;
+    }
+    return CaptureKind_UNBOUND;
+}
+
+// bind free names of nested functions to closure slots, now that `co` is complete
+static void resolve_captures(CodeObject* co, FuncDecl* func) {
+    c11__foreach(FuncDecl_, &co->func_decls, it) {
+        FuncDecl* decl = *it;
+        if(!decl->nested) continue;
+        // slots forwarded for functions nested deeper in `decl`
+        for(int i = 0; i < decl->captures.length; i++) {
+            FuncDeclCapture* capture = c11__at(FuncDeclCapture, &decl->captures, i);
+            int index;
+            CaptureKind kind = resolve_capture(co, func, decl, capture->name, &index);
+            capture = c11__at(FuncDeclCapture, &decl->captures, i);
+            capture->kind = kind;
+            capture->index = index;
+        }
+        // free names of `decl` itself
+        Bytecode* codes = decl->code.codes.data;
+        bool changed = false;
+        for(int i = 0; i < decl->code.codes.length; i++) {
+            if(codes[i].op != OP_LOAD_NONLOCAL) continue;
+            py_Name name = c11__getitem(py_Name, &decl->code.names, codes[i].arg);
+            int index;
+            CaptureKind kind = resolve_capture(co, func, decl, name, &index);
+            if(kind == CaptureKind_UNBOUND) continue;  // a global or builtin
+            int slot = FuncDecl__capture_slot(decl, name);
+            FuncDeclCapture* capture = c11__at(FuncDeclCapture, &decl->captures, slot);
+            capture->kind = kind;
+            capture->index = index;
+            codes[i].op = OP_LOAD_CLOSURE;
+            codes[i].arg = slot;
+            changed = true;
+        }
+        if(changed) CodeObject__init_caches(&decl->code);
+    }
+}
+
 static Error* pop_context(Compiler* self) {
     // add a `return None` in the end as a guard
     // previously, we only do this if the last opcode is not a return
@@ -1538,6 +1898,14 @@ static Error* pop_context(Compiler* self) {
             Bytecode__set_signed_arg(bc, block->end - i);
         }
     }
+#if !PK_ENABLE_OPCODE_STATS
+    // opcode stats are mined from unfused bytecodes
+    fuse_superinstructions(co);
+#endif
+    // nested functions are complete, the locals they may capture are known now
+    resolve_captures(co, ctx()->func);
+    // allocate inline caches after all bytecodes are settled
+    CodeObject__init_caches(co);
     // pre-compute func->is_simple
     FuncDecl* func = ctx()->func;
     if(func) {
@@ -1728,11 +2096,10 @@ static Error* exprUnaryOp(Compiler* self) {
     switch(op) {
         case TK_SUB: {
             // constant fold
-            if(e->vt->is_literal) {
-                LiteralExpr* le = (LiteralExpr*)e;
-                if(le->value->index == TokenValue_I64 || le->value->index == TokenValue_F64) {
-                    le->negated = true;
-                }
+            LiteralExpr* le = (LiteralExpr*)e;
+            if(e->vt->is_literal &&
+               (le->value->index == TokenValue_I64 || le->value->index == TokenValue_F64)) {
+                le->negated = !le->negated;
                 Ctx__s_push(ctx(), e);
             } else {
                 Ctx__s_push(ctx(), (Expr*)UnaryExpr__new(line, e, OP_UNARY_NEGATIVE));
@@ -2084,9 +2451,51 @@ static Error* compile_block_body(Compiler* self) {
     return NULL;
 }
 
+// returns 1 or 0 if the condition is a constant, otherwise -1
+static int Ctx__s_top_truthiness(Ctx* self) {
+    py_TValue value;
+    if(!vtfold(Ctx__s_top(self), &value)) return -1;
+    return py_bool(&value);
+}
+
+// compile code that can never run, then drop its bytecodes
+// names, locals and nested functions it declares are kept
+static Error* compile_unreachable(Compiler* self, Error* (*compile)(Compiler*)) {
+    Error* err;
+    CodeObject* co = ctx()->co;
+    int codes_length = co->codes.length;
+    int blocks_length = co->blocks.length;
+    int exc_handlers_length = co->exc_handlers.length;
+    check(compile(self));
+    Bytecode* codes = co->codes.data;
+    for(int i = codes_length; i < co->codes.length; i++) {
+        // `if False: yield` still makes a generator
+        if(codes[i].op == OP_YIELD_VALUE || codes[i].op == OP_FOR_ITER_YIELD_VALUE) {
+            if(ctx()->func) ctx()->func->type = FuncType_GENERATOR;
+        }
+    }
+    co->codes.length = codes_length;
+    co->codes_ex.length = codes_length;
+    co->blocks.length = blocks_length;
+    co->exc_handlers.length = exc_handlers_length;
+    return NULL;
+}
+
 static Error* compile_if_stmt(Compiler* self) {
     Error* err;
     check(EXPR(self));  // condition
+    int cond = Ctx__s_top_truthiness(ctx());
+    if(cond >= 0) {
+        // only the branch that runs is emitted
+        Ctx__s_pop(ctx());
+        check(cond ? compile_block_body(self) : compile_unreachable(self, compile_block_body));
+        if(match(TK_ELIF)) {
+            check(cond ? compile_unreachable(self, compile_if_stmt) : compile_if_stmt(self));
+        } else if(match(TK_ELSE)) {
+            check(cond ? compile_unreachable(self, compile_block_body) : compile_block_body(self));
+        }
+        return NULL;
+    }
     Ctx__s_emit_top(ctx());
     int patch = Ctx__emit_(ctx(), OP_POP_JUMP_IF_FALSE, BC_NOARG, prev()->line);
     err = compile_block_body(self);
@@ -2160,11 +2569,28 @@ static Error* compile_while_loop(Compiler* self) {
     int block = Ctx__enter_block(ctx(), CodeBlockType_WHILE_LOOP);
     int block_start = c11__at(CodeBlock, &ctx()->co->blocks, block)->start;
     check(EXPR(self));  // condition
-    Ctx__s_emit_top(ctx());
-    int patch = Ctx__emit_(ctx(), OP_POP_JUMP_IF_FALSE, BC_NOARG, prev()->line);
-    check(compile_block_body(self));
-    Ctx__emit_jump(ctx(), block_start, BC_KEEPLINE);
-    Ctx__patch_jump(ctx(), patch);
+    int cond = Ctx__s_top_truthiness(ctx());
+    if(cond == 0) {
+        // `while False:` never enters the body
+        Ctx__s_pop(ctx());
+        check(compile_unreachable(self, compile_block_body));
+    } else {
+        int patch = -1;
+        if(cond == 1) {
+            // `while True:` needs no test
+            Ctx__s_pop(ctx());
+        } else {
+            Ctx__s_emit_top(ctx());
+            patch = Ctx__emit_(ctx(), OP_POP_JUMP_IF_FALSE, BC_NOARG, prev()->line);
+        }
+        check(compile_block_body(self));
+        // the backward jump must not target itself, it would never burn fuel
+        if(ctx()->co->codes.length == block_start) {
+            Ctx__emit_(ctx(), OP_NO_OP, BC_NOARG, BC_KEEPLINE);
+        }
+        Ctx__emit_jump(ctx(), block_start, BC_KEEPLINE);
+        if(patch >= 0) Ctx__patch_jump(ctx(), patch);
+    }
     Ctx__exit_block(ctx());
     // optional else clause
     if(match(TK_ELSE)) {
@@ -2626,8 +3052,12 @@ static Error* compile_try_except(Compiler* self) {
     int patches[8];
     int patches_length = 0;
 
+    // entering a try block emits nothing, the handler is recorded in the exception table
+    int handler = ctx()->co->exc_handlers.length;
+    ExceptionHandler* h = c11_vector__emplace(&ctx()->co->exc_handlers);
+    h->start = ctx()->co->codes.length;
+    h->depth = Ctx__stack_depth(ctx());
     Ctx__enter_block(ctx(), CodeBlockType_TRY);
-    Ctx__emit_(ctx(), OP_TRY_ENTER, BC_NOARG, prev()->line);
     check(compile_block_body(self));
 
     // https://docs.python.org/3/reference/compound_stmts.html#finally-clause
@@ -2648,6 +3078,9 @@ static Error* compile_try_except(Compiler* self) {
         patches[patches_length++] = Ctx__emit_(ctx(), OP_JUMP_FORWARD, BC_NOARG, BC_KEEPLINE);
     }
     Ctx__exit_block(ctx());
+    h = c11__at(ExceptionHandler, &ctx()->co->exc_handlers, handler);
+    h->end = ctx()->co->codes.length;
+    h->target = h->end;
 
     if(has_finally) {
         consume(TK_FINALLY);
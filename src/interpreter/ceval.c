@@ -1,6 +1,8 @@
 #include "pocketpy/common/str.h"
 #include "pocketpy/common/utils.h"
 #include "pocketpy/interpreter/frame.h"
+#include "pocketpy/interpreter/generator.h"
+#include "pocketpy/interpreter/types.h"
 #include "pocketpy/interpreter/vm.h"
 #include "pocketpy/common/sstream.h"
 #include "pocketpy/objects/codeobject.h"
@@ -16,28 +18,91 @@ static bool stack_format_object(VM* self, c11_sv spec);
 #define CHECK_RETURN_FROM_EXCEPT_OR_FINALLY()                                                      \
     if(self->is_curr_exc_handled) py_clearexc(NULL)
 
+// threaded dispatch needs GCC/Clang's labels-as-values extension
+#if PK_ENABLE_COMPUTED_GOTO && (defined(__GNUC__) || defined(__clang__))
+    #define PK_USE_COMPUTED_GOTO 1
+#else
+    #define PK_USE_COMPUTED_GOTO 0
+#endif
+
+// whether any per-step hook (tracing, profiling, debugging) needs the instrumented loop
+#if PK_ENABLE_OPCODE_STATS
+    #define STEP_HOOKS_ACTIVE() true
+#else
+    #define STEP_HOOKS_ACTIVE() (self->trace_info.func != NULL)
+#endif
+
+#if PK_USE_COMPUTED_GOTO
+    // jump straight to the handler of the next opcode, so that each handler owns
+    // its own indirect branch; the instrumented table routes every opcode through `__NEXT_STEP`
+    #define CASE(op) case op: L_##op:
+    #define GOTO_NEXT_STEP()                                                                       \
+        do {                                                                                       \
+            byte = co_codes[frame->ip];                                                            \
+            goto* dispatch_table[byte.op];                                                         \
+        } while(0)
+    #define SELECT_LOOP()                                                                          \
+        do {                                                                                       \
+            instrumented = STEP_HOOKS_ACTIVE();                                                    \
+            dispatch_table = instrumented ? STEP_LABELS : OP_LABELS;                               \
+        } while(0)
+#else
+    #define CASE(op) case op:
+    #define GOTO_NEXT_STEP() goto __NEXT_STEP
+    #define SELECT_LOOP() instrumented = STEP_HOOKS_ACTIVE()
+#endif
+
 #define DISPATCH()                                                                                 \
     do {                                                                                           \
         frame->ip++;                                                                               \
-        goto __NEXT_STEP;                                                                          \
+        GOTO_NEXT_STEP();                                                                          \
     } while(0)
 #define DISPATCH_JUMP(__offset)                                                                    \
     do {                                                                                           \
         frame->ip += __offset;                                                                     \
-        goto __NEXT_STEP;                                                                          \
+        GOTO_NEXT_STEP();                                                                          \
     } while(0)
 #define DISPATCH_JUMP_ABSOLUTE(__target)                                                           \
     do {                                                                                           \
         frame->ip = __target;                                                                      \
-        goto __NEXT_STEP;                                                                          \
+        GOTO_NEXT_STEP();                                                                          \
     } while(0)
 
+#if PK_ENABLE_WATCHDOG
+    // burn watchdog fuel, only on backward jumps and frame switches
+    #define BURN_FUEL(__units)                                                                     \
+        do {                                                                                       \
+            self->watchdog_info.fuel -= (__units);                                                 \
+            if(self->watchdog_info.fuel < 0 && !pk_watchdog_refuel(self)) goto __ERROR;            \
+        } while(0)
+#else
+    #define BURN_FUEL(__units) (void)0
+#endif
+
 #define RESET_CO_CACHE()                                                                           \
     do {                                                                                           \
         co_codes = frame->co->codes.data;                                                          \
         co_names = frame->co->names.data;                                                          \
     } while(0)
 
+// inline cache slot of the current attribute instruction
+#define ATTR_CACHE()                                                                               \
+    c11__at(AttrCache,                                                                             \
+            &frame->co->attr_caches,                                                               \
+            c11__getitem(BytecodeEx, &frame->co->codes_ex, frame->ip).icache)
+
+// inline cache slot of the current CALL with keyword arguments
+#define CALL_CACHE()                                                                               \
+    c11__at(CallCache,                                                                             \
+            &frame->co->call_caches,                                                               \
+            c11__getitem(BytecodeEx, &frame->co->codes_ex, frame->ip).icache)
+
+// inline cache slot of the current LOAD_GLOBAL or LOAD_NONLOCAL
+#define GLOBAL_CACHE()                                                                             \
+    c11__at(GlobalCache,                                                                           \
+            &frame->co->global_caches,                                                             \
+            c11__getitem(BytecodeEx, &frame->co->codes_ex, frame->ip).icache)
+
 /* Stack manipulation macros */
 // https://github.com/python/cpython/blob/3.9/Python/ceval.c#L1123
 #define TOP() (self->stack.sp - 1)
@@ -63,11 +128,14 @@ static bool stack_format_object(VM* self, c11_sv spec);
     } while(0)
 
 // Must use a DISPATCH() after vectorcall_opcall() immediately!
-#define vectorcall_opcall(argc, kwargc)                                                            \
+#define vectorcall_opcall(argc, kwargc, cache)                                                     \
     do {                                                                                           \
-        FrameResult res = VM__vectorcall(self, (argc), (kwargc), true);                            \
+        FrameResult res = VM__vectorcall(self, (argc), (kwargc), true, (cache));                   \
         switch(res) {                                                                              \
-            case RES_RETURN: PUSH(&self->last_retval); break;                                      \
+            case RES_RETURN:                                                                       \
+                PUSH(&self->last_retval);                                                          \
+                SELECT_LOOP();                                                                     \
+                break;                                                                             \
             case RES_CALL: frame = self->top_frame; goto __NEXT_FRAME;                             \
             case RES_ERROR: goto __ERROR;                                                          \
             default: c11__unreachable();                                                           \
@@ -86,6 +154,182 @@ static bool unpack_dict_to_buffer(py_Ref key, py_Ref val, void* ctx) {
     return TypeError("keywords must be strings, not '%t'", key->type);
 }
 
+#if PK_ENABLE_WATCHDOG
+// called when the watchdog fuel runs out, returns false if the watchdog fires
+static bool pk_watchdog_refuel(VM* self) {
+    WatchdogInfo* info = &self->watchdog_info;
+    if(info->is_fuel_limited) {
+        info->is_fuel_limited = false;
+        info->fuel = INT64_MAX;
+        return TimeoutError("watchdog fuel exhausted");
+    }
+    if(info->max_reset_time > 0) {
+        if(clock() > info->max_reset_time) {
+            info->max_reset_time = 0;
+            info->fuel = INT64_MAX;
+            return TimeoutError("watchdog timeout");
+        }
+        info->fuel = PK_WATCHDOG_CLOCK_INTERVAL;
+        return true;
+    }
+    info->fuel = INT64_MAX;
+    return true;
+}
+#endif
+
+// resolve a global name of a module through the inline cache, NULL if not found
+static py_ItemRef
+    pk_loadglobal_cached(VM* self, py_Ref module, py_Name name, GlobalCache* cache) {
+    uint32_t module_version = ((py_ModuleInfo*)py_touserdata(module))->dict_version;
+    uint32_t builtins_version = ((py_ModuleInfo*)py_touserdata(self->builtins))->dict_version;
+    if(cache->module == module->_obj && cache->module_version == module_version &&
+       (cache->builtins_version == 0 || cache->builtins_version == builtins_version)) {
+        return cache->slot;
+    }
+    // items of a module dict stay in place until a key is added or removed
+    py_ItemRef item = py_getdict(module, name);
+    uint32_t found_in_builtins = 0;
+    if(item == NULL) {
+        item = py_getdict(self->builtins, name);
+        found_in_builtins = builtins_version;
+    }
+    if(item == NULL || py_isnil(item)) return item;
+    cache->module = module->_obj;
+    cache->module_version = module_version;
+    cache->builtins_version = found_in_builtins;
+    cache->slot = item;
+    return item;
+}
+
+#if PK_ENABLE_COMPACT_TVALUE
+// a compact payload holds the current value and `stop` of a range as two 32-bit integers
+static py_i64 pk_forrange_curr(const py_TValue* val) { return val->_vec2i.x; }
+
+static py_i64 pk_forrange_stop(const py_TValue* val) { return val->_vec2i.y; }
+
+static void pk_forrange_setcurr(py_TValue* val, py_i64 curr) {
+    // clamp to `stop` so that the last step cannot overflow
+    py_i64 stop = val->_vec2i.y;
+    val->_vec2i.x = (int)(val->extra > 0 ? c11__min(curr, stop) : c11__max(curr, stop));
+}
+
+static bool pk_forrange_init(py_TValue* val, py_i64 start, py_i64 stop) {
+    if(start < INT32_MIN || start > INT32_MAX || stop < INT32_MIN || stop > INT32_MAX) {
+        return false;
+    }
+    val->_vec2i.x = (int)start;
+    val->_vec2i.y = (int)stop;
+    return true;
+}
+#else
+// unboxed `for` loop states keep a second integer in the upper half of the payload
+static py_i64 pk_forstate_hi(const py_TValue* val) {
+    py_i64 res;
+    memcpy(&res, val->_chars + 8, sizeof(py_i64));
+    return res;
+}
+
+static void pk_forstate_sethi(py_TValue* val, py_i64 hi) {
+    memcpy(val->_chars + 8, &hi, sizeof(py_i64));
+}
+
+static py_i64 pk_forrange_curr(const py_TValue* val) { return val->_i64; }
+
+static py_i64 pk_forrange_stop(const py_TValue* val) { return pk_forstate_hi(val); }
+
+static void pk_forrange_setcurr(py_TValue* val, py_i64 curr) { val->_i64 = curr; }
+
+static bool pk_forrange_init(py_TValue* val, py_i64 start, py_i64 stop) {
+    val->_i64 = start;
+    pk_forstate_sethi(val, stop);
+    return true;
+}
+#endif
+
+// the FOR_ITER variant that consumes a value of `type` from the iterator slot
+static Opcode pk_for_iter_op(py_Type type) {
+    switch(type) {
+        case tp_for_range: return OP_FOR_ITER_RANGE;
+        case tp_for_list: return OP_FOR_ITER_LIST;
+        case tp_for_tuple: return OP_FOR_ITER_TUPLE;
+        case tp_for_str: return OP_FOR_ITER_STR;
+        case tp_for_dict: return OP_FOR_ITER_DICT;
+        default: return OP_FOR_ITER;
+    }
+}
+
+// turn a builtin container into an unboxed `for` loop state in place
+// returns false if `val` needs a real iterator object
+static bool pk_unbox_iterable(py_TValue* val) {
+    switch(val->type) {
+        case tp_range: {
+            Range r = *(Range*)py_touserdata(val);
+            if(r.step < INT32_MIN || r.step > INT32_MAX) return false;
+            if(!pk_forrange_init(val, r.start, r.stop)) return false;
+            val->type = tp_for_range;
+            val->is_ptr = false;
+            val->extra = (int)r.step;
+            return true;
+        }
+        case tp_list: val->type = tp_for_list; break;
+        case tp_tuple: val->type = tp_for_tuple; break;
+        case tp_str:
+            // short strings are stored inline and have no room for an offset
+            if(!val->is_ptr) return false;
+            val->type = tp_for_str;
+            break;
+        case tp_dict:
+#if PK_ENABLE_COMPACT_TVALUE
+            // no room to check the version for modifications, use a real iterator
+            return false;
+#else
+            val->type = tp_for_dict;
+            pk_forstate_sethi(val, ((Dict*)py_touserdata(val))->version);
+            break;
+#endif
+        default: return false;
+    }
+    val->extra = 0;
+    return true;
+}
+
+// pick the variant of a generic binary op specialized for the observed operand types
+static Opcode pk_specialize_binaryop(Opcode op, py_Type lhs, py_Type rhs) {
+    if(lhs != rhs) return op;
+    if(lhs == tp_int) {
+        switch(op) {
+            case OP_BINARY_ADD: return OP_BINARY_ADD_INT;
+            case OP_BINARY_SUB: return OP_BINARY_SUB_INT;
+            case OP_BINARY_MUL: return OP_BINARY_MUL_INT;
+            case OP_BINARY_FLOORDIV: return OP_BINARY_FLOORDIV_INT;
+            case OP_BINARY_MOD: return OP_BINARY_MOD_INT;
+            case OP_COMPARE_LT: return OP_COMPARE_LT_INT;
+            case OP_COMPARE_LE: return OP_COMPARE_LE_INT;
+            case OP_COMPARE_EQ: return OP_COMPARE_EQ_INT;
+            case OP_COMPARE_NE: return OP_COMPARE_NE_INT;
+            case OP_COMPARE_GT: return OP_COMPARE_GT_INT;
+            case OP_COMPARE_GE: return OP_COMPARE_GE_INT;
+            default: return op;
+        }
+    }
+    if(lhs == tp_float) {
+        switch(op) {
+            case OP_BINARY_ADD: return OP_BINARY_ADD_FLOAT;
+            case OP_BINARY_SUB: return OP_BINARY_SUB_FLOAT;
+            case OP_BINARY_MUL: return OP_BINARY_MUL_FLOAT;
+            case OP_BINARY_TRUEDIV: return OP_BINARY_TRUEDIV_FLOAT;
+            case OP_COMPARE_LT: return OP_COMPARE_LT_FLOAT;
+            case OP_COMPARE_LE: return OP_COMPARE_LE_FLOAT;
+            case OP_COMPARE_EQ: return OP_COMPARE_EQ_FLOAT;
+            case OP_COMPARE_NE: return OP_COMPARE_NE_FLOAT;
+            case OP_COMPARE_GT: return OP_COMPARE_GT_FLOAT;
+            case OP_COMPARE_GE: return OP_COMPARE_GE_FLOAT;
+            default: return op;
+        }
+    }
+    return op;
+}
+
 FrameResult VM__run_top_frame(VM* self) {
     py_Frame* frame = self->top_frame;
     Bytecode* co_codes;
@@ -93,64 +337,87 @@ FrameResult VM__run_top_frame(VM* self) {
     Bytecode byte;
 
     const py_Frame* base_frame = frame;
+#if PK_ENABLE_OPCODE_STATS
+    int prev_op = -1;
+#endif
+
+    // The loop runs in one of two modes. The fast one has no per-step hooks at all, while
+    // the instrumented one goes through `__NEXT_STEP` before every instruction. Hooks are
+    // toggled by native code, so the mode is re-selected whenever a frame is entered or left,
+    // a native call returns, a loop jumps backward or an exception is caught.
+    bool instrumented;
+#if PK_USE_COMPUTED_GOTO
+    static const void* const OP_LABELS[] = {
+    #define OPCODE(name) [OP_##name] = &&L_OP_##name,
+    #include "pocketpy/xmacros/opcodes.h"
+    #undef OPCODE
+    };
+    static const void* const STEP_LABELS[] = {
+    #define OPCODE(name) [OP_##name] = &&__NEXT_STEP,
+    #include "pocketpy/xmacros/opcodes.h"
+    #undef OPCODE
+    };
+    const void* const* dispatch_table;
+#endif
 
 __NEXT_FRAME:
     if(self->recursion_depth >= self->max_recursion_depth) {
         py_exception(tp_RecursionError, "maximum recursion depth exceeded");
         goto __ERROR;
     }
+    BURN_FUEL(1);
     RESET_CO_CACHE();
     frame->ip++;
+    SELECT_LOOP();
+#if PK_ENABLE_OPCODE_STATS
+    prev_op = -1;
+#endif
 
 __NEXT_STEP:
     byte = co_codes[frame->ip];
 
-    if(self->trace_info.func) {
-        bool is_virtual = byte.op == OP_RETURN_VALUE && byte.arg == BC_RETURN_VIRTUAL;
-        if(!is_virtual) {
-            SourceLocation loc = Frame__source_location(frame);
-            SourceLocation prev_loc = self->trace_info.prev_loc;
-            if(loc.lineno != prev_loc.lineno || loc.src != prev_loc.src) {
-                if(prev_loc.src) PK_DECREF(prev_loc.src);
-                PK_INCREF(loc.src);
-                self->trace_info.prev_loc = loc;
-                self->trace_info.func(frame, TRACE_EVENT_LINE);
+    if(instrumented) {
+        if(self->trace_info.func) {
+            bool is_virtual = byte.op == OP_RETURN_VALUE && byte.arg == BC_RETURN_VIRTUAL;
+            if(!is_virtual) {
+                SourceLocation loc = Frame__source_location(frame);
+                SourceLocation prev_loc = self->trace_info.prev_loc;
+                if(loc.lineno != prev_loc.lineno || loc.src != prev_loc.src) {
+                    if(prev_loc.src) PK_DECREF(prev_loc.src);
+                    PK_INCREF(loc.src);
+                    self->trace_info.prev_loc = loc;
+                    self->trace_info.func(frame, TRACE_EVENT_LINE);
+                }
             }
         }
-    }
 
-#if PK_ENABLE_WATCHDOG
-    if(self->watchdog_info.max_reset_time > 0) {
-        clock_t now = clock();
-        if(now > self->watchdog_info.max_reset_time) {
-            self->watchdog_info.max_reset_time = 0;
-            TimeoutError("watchdog timeout");
-            goto __ERROR;
-        }
-    }
+#if PK_ENABLE_OPCODE_STATS
+        if(prev_op >= 0) self->opcode_pairs[prev_op][byte.op]++;
+        prev_op = byte.op;
 #endif
+    }
 
 #ifndef NDEBUG
     pk_print_stack(self, frame, byte);
 #endif
 
     switch((Opcode)byte.op) {
-        case OP_NO_OP: DISPATCH();
+        CASE(OP_NO_OP) DISPATCH();
         /*****************************************/
-        case OP_POP_TOP: POP(); DISPATCH();
-        case OP_DUP_TOP: PUSH(TOP()); DISPATCH();
-        case OP_DUP_TOP_TWO:
+        CASE(OP_POP_TOP) POP(); DISPATCH();
+        CASE(OP_DUP_TOP) PUSH(TOP()); DISPATCH();
+        CASE(OP_DUP_TOP_TWO)
             // [a, b]
             PUSH(SECOND());  // [a, b, a]
             PUSH(SECOND());  // [a, b, a, b]
             DISPATCH();
-        case OP_ROT_TWO: {
+        CASE(OP_ROT_TWO) {
             py_TValue tmp = *TOP();
             *TOP() = *SECOND();
             *SECOND() = tmp;
             DISPATCH();
         }
-        case OP_ROT_THREE: {
+        CASE(OP_ROT_THREE) {
             // [a, b, c] -> [c, a, b]
             py_TValue tmp = *TOP();
             *TOP() = *SECOND();
@@ -158,7 +425,7 @@ __NEXT_STEP:
             *THIRD() = tmp;
             DISPATCH();
         }
-        case OP_PRINT_EXPR:
+        CASE(OP_PRINT_EXPR)
             if(TOP()->type != tp_NoneType) {
                 bool ok = py_repr(TOP());
                 if(!ok) goto __ERROR;
@@ -168,65 +435,75 @@ __NEXT_STEP:
             POP();
             DISPATCH();
         /*****************************************/
-        case OP_LOAD_CONST: {
+        CASE(OP_LOAD_CONST) {
             PUSH(c11__at(py_TValue, &frame->co->consts, byte.arg));
             DISPATCH();
         }
-        case OP_LOAD_NONE: {
+        CASE(OP_LOAD_NONE) {
             py_newnone(SP()++);
             DISPATCH();
         }
-        case OP_LOAD_TRUE: {
+        CASE(OP_LOAD_TRUE) {
             py_newbool(SP()++, true);
             DISPATCH();
         }
-        case OP_LOAD_FALSE: {
+        CASE(OP_LOAD_FALSE) {
             py_newbool(SP()++, false);
             DISPATCH();
         }
         /*****************************************/
-        case OP_LOAD_SMALL_INT: {
+        CASE(OP_LOAD_SMALL_INT) {
             py_newint(SP()++, (int16_t)byte.arg);
             DISPATCH();
         }
         /*****************************************/
-        case OP_LOAD_ELLIPSIS: {
+        CASE(OP_LOAD_ELLIPSIS) {
             py_newellipsis(SP()++);
             DISPATCH();
         }
-        case OP_LOAD_FUNCTION: {
+        CASE(OP_LOAD_FUNCTION) {
             FuncDecl_ decl = c11__getitem(FuncDecl_, &frame->co->func_decls, byte.arg);
-            Function* ud = py_newobject(SP(), tp_function, 0, sizeof(Function));
+            // captured variables are stored in the slots of the function object
+            int ncaptures = decl->captures.length;
+            Function* ud = py_newobject(SP(), tp_function, ncaptures, sizeof(Function));
             Function__ctor(ud, decl, frame->module, frame->globals);
             if(decl->nested) {
                 if(frame->is_locals_special) {
                     RuntimeError("cannot create closure from special locals");
                     goto __ERROR;
                 }
-                ud->closure = FastLocals__to_namedict(frame->locals, frame->co);
-                py_Name name = py_name(decl->code.name->data);
-                // capture itself to allow recursion
-                NameDict__set(ud->closure, name, SP());
+                py_TValue* slots = PyObject__slots(SP()->_obj);
+                for(int i = 0; i < ncaptures; i++) {
+                    FuncDeclCapture* capture = c11__at(FuncDeclCapture, &decl->captures, i);
+                    switch(capture->kind) {
+                        case CaptureKind_LOCAL: slots[i] = frame->locals[capture->index]; break;
+                        case CaptureKind_CLOSURE:
+                            slots[i] = PyObject__slots(frame->p0->_obj)[capture->index];
+                            break;
+                        case CaptureKind_SELF: slots[i] = *SP(); break;
+                        default: break;
+                    }
+                }
             }
             SP()++;
             DISPATCH();
         }
-        case OP_LOAD_NULL:
+        CASE(OP_LOAD_NULL)
             py_newnil(SP()++);
             DISPATCH();
             /*****************************************/
-        case OP_LOAD_FAST: {
+        CASE(OP_LOAD_FAST) {
             assert(!frame->is_locals_special);
             py_Ref val = &frame->locals[byte.arg];
             if(!py_isnil(val)) {
                 PUSH(val);
                 DISPATCH();
             }
-            py_Name name = c11__getitem(py_Name, &frame->co->varnames, byte.arg);
-            UnboundLocalError(name);
+        __UNBOUND_LOCAL:
+            UnboundLocalError(c11__getitem(py_Name, &frame->co->varnames, byte.arg));
             goto __ERROR;
         }
-        case OP_LOAD_NAME: {
+        CASE(OP_LOAD_NAME) {
             assert(frame->is_locals_special);
             py_Name name = co_names[byte.arg];
             // locals
@@ -271,13 +548,50 @@ __NEXT_STEP:
             NameError(name);
             goto __ERROR;
         }
-        case OP_LOAD_NONLOCAL: {
-            py_Name name = co_names[byte.arg];
-            py_Ref tmp = Frame__getclosure(frame, name);
+        CASE(OP_LOAD_CLOSURE) {
+            py_Ref tmp = &PyObject__slots(frame->p0->_obj)[byte.arg];
+            if(!py_isnil(tmp)) {
+                PUSH(tmp);
+                DISPATCH();
+            }
+            // the variable was unbound when the closure was created
+            Function* ud = py_touserdata(frame->p0);
+            py_Name name = c11__at(FuncDeclCapture, &ud->decl->captures, byte.arg)->name;
+            if(frame->globals->type == tp_module) {
+                tmp = pk_loadglobal_cached(self, frame->globals, name, GLOBAL_CACHE());
+                if(tmp != NULL) {
+                    PUSH(tmp);
+                    DISPATCH();
+                }
+                NameError(name);
+                goto __ERROR;
+            }
+            int res = Frame__getglobal(frame, name);
+            if(res == 1) {
+                PUSH(&self->last_retval);
+                DISPATCH();
+            }
+            if(res == -1) goto __ERROR;
+            tmp = py_getdict(self->builtins, name);
             if(tmp != NULL) {
                 PUSH(tmp);
                 DISPATCH();
             }
+            NameError(name);
+            goto __ERROR;
+        }
+        CASE(OP_LOAD_NONLOCAL) {
+            py_Name name = co_names[byte.arg];
+            py_Ref tmp;
+            if(frame->globals->type == tp_module) {
+                tmp = pk_loadglobal_cached(self, frame->globals, name, GLOBAL_CACHE());
+                if(tmp != NULL) {
+                    PUSH(tmp);
+                    DISPATCH();
+                }
+                NameError(name);
+                goto __ERROR;
+            }
             int res = Frame__getglobal(frame, name);
             if(res == 1) {
                 PUSH(&self->last_retval);
@@ -293,8 +607,17 @@ __NEXT_STEP:
             NameError(name);
             goto __ERROR;
         }
-        case OP_LOAD_GLOBAL: {
+        CASE(OP_LOAD_GLOBAL) {
             py_Name name = co_names[byte.arg];
+            if(frame->globals->type == tp_module) {
+                py_ItemRef item = pk_loadglobal_cached(self, frame->globals, name, GLOBAL_CACHE());
+                if(item != NULL) {
+                    PUSH(item);
+                    DISPATCH();
+                }
+                NameError(name);
+                goto __ERROR;
+            }
             int res = Frame__getglobal(frame, name);
             if(res == 1) {
                 PUSH(&self->last_retval);
@@ -309,16 +632,16 @@ __NEXT_STEP:
             NameError(name);
             goto __ERROR;
         }
-        case OP_LOAD_ATTR: {
+        CASE(OP_LOAD_ATTR) {
             py_Name name = co_names[byte.arg];
-            if(py_getattr(TOP(), name)) {
+            if(pk_getattr_cached(TOP(), name, ATTR_CACHE())) {
                 py_assign(TOP(), py_retval());
             } else {
                 goto __ERROR;
             }
             DISPATCH();
         }
-        case OP_LOAD_CLASS_GLOBAL: {
+        CASE(OP_LOAD_CLASS_GLOBAL) {
             assert(self->curr_class);
             py_Name name = co_names[byte.arg];
             py_Ref tmp = py_getdict(self->curr_class, name);
@@ -341,11 +664,13 @@ __NEXT_STEP:
             NameError(name);
             goto __ERROR;
         }
-        case OP_LOAD_METHOD: {
+        CASE(OP_LOAD_METHOD) {
             // [self] -> [unbound, self]
             py_Name name = co_names[byte.arg];
-            bool ok = py_pushmethod(name);
-            if(!ok) {
+            bool ok = pk_loadmethod_cached(TOP(), name, ATTR_CACHE());
+            if(ok) {
+                SP()++;
+            } else {
                 // fallback to getattr
                 if(py_getattr(TOP(), name)) {
                     py_assign(TOP(), py_retval());
@@ -356,9 +681,9 @@ __NEXT_STEP:
             }
             DISPATCH();
         }
-        case OP_LOAD_SUBSCR: {
+        CASE(OP_LOAD_SUBSCR) {
             // [a, b] -> a[b]
-            py_Ref magic = py_tpfindmagic(SECOND()->type, __getitem__);
+            py_Ref magic = pk_tpfindmagicslot(pk_typeinfo(SECOND()->type), MagicSlot___getitem__);
             if(magic) {
                 if(magic->type == tp_nativefunc) {
                     if(!py_callcfunc(magic->_cfunc, 2, SECOND())) goto __ERROR;
@@ -367,19 +692,19 @@ __NEXT_STEP:
                 } else {
                     INSERT_THIRD();     // [?, a, b]
                     *THIRD() = *magic;  // [__getitem__, a, b]
-                    vectorcall_opcall(1, 0);
+                    vectorcall_opcall(1, 0, NULL);
                 }
                 DISPATCH();
             }
             TypeError("'%t' object is not subscriptable", SECOND()->type);
             goto __ERROR;
         }
-        case OP_STORE_FAST: {
+        CASE(OP_STORE_FAST) {
             assert(!frame->is_locals_special);
             frame->locals[byte.arg] = POPX();
             DISPATCH();
         }
-        case OP_STORE_NAME: {
+        CASE(OP_STORE_NAME) {
             assert(frame->is_locals_special);
             py_Name name = co_names[byte.arg];
             switch(frame->locals->type) {
@@ -407,22 +732,22 @@ __NEXT_STEP:
                 default: c11__unreachable();
             }
         }
-        case OP_STORE_GLOBAL: {
+        CASE(OP_STORE_GLOBAL) {
             py_Name name = co_names[byte.arg];
             if(!Frame__setglobal(frame, name, TOP())) goto __ERROR;
             POP();
             DISPATCH();
         }
-        case OP_STORE_ATTR: {
+        CASE(OP_STORE_ATTR) {
             // [val, a] -> a.b = val
             py_Name name = co_names[byte.arg];
-            if(!py_setattr(TOP(), name, SECOND())) goto __ERROR;
+            if(!pk_setattr_cached(TOP(), name, SECOND(), ATTR_CACHE())) goto __ERROR;
             STACK_SHRINK(2);
             DISPATCH();
         }
-        case OP_STORE_SUBSCR: {
+        CASE(OP_STORE_SUBSCR) {
             // [val, a, b] -> a[b] = val
-            py_Ref magic = py_tpfindmagic(SECOND()->type, __setitem__);
+            py_Ref magic = pk_tpfindmagicslot(pk_typeinfo(SECOND()->type), MagicSlot___setitem__);
             if(magic) {
                 PUSH(THIRD());  // [val, a, b, val]
                 if(magic->type == tp_nativefunc) {
@@ -437,7 +762,7 @@ __NEXT_STEP:
             TypeError("'%t' object does not support item assignment", SECOND()->type);
             goto __ERROR;
         }
-        case OP_DELETE_FAST: {
+        CASE(OP_DELETE_FAST) {
             assert(!frame->is_locals_special);
             py_Ref tmp = &frame->locals[byte.arg];
             if(py_isnil(tmp)) {
@@ -448,7 +773,7 @@ __NEXT_STEP:
             py_newnil(tmp);
             DISPATCH();
         }
-        case OP_DELETE_NAME: {
+        CASE(OP_DELETE_NAME) {
             assert(frame->is_locals_special);
             py_Name name = co_names[byte.arg];
             switch(frame->locals->type) {
@@ -478,7 +803,7 @@ __NEXT_STEP:
                 default: c11__unreachable();
             }
         }
-        case OP_DELETE_GLOBAL: {
+        CASE(OP_DELETE_GLOBAL) {
             py_Name name = co_names[byte.arg];
             int res = Frame__delglobal(frame, name);
             if(res == 1) DISPATCH();
@@ -487,15 +812,16 @@ __NEXT_STEP:
             goto __ERROR;
         }
 
-        case OP_DELETE_ATTR: {
+        CASE(OP_DELETE_ATTR) {
             py_Name name = co_names[byte.arg];
             if(!py_delattr(TOP(), name)) goto __ERROR;
+            POP();
             DISPATCH();
         }
 
-        case OP_DELETE_SUBSCR: {
+        CASE(OP_DELETE_SUBSCR) {
             // [a, b] -> del a[b]
-            py_Ref magic = py_tpfindmagic(SECOND()->type, __delitem__);
+            py_Ref magic = pk_tpfindmagicslot(pk_typeinfo(SECOND()->type), MagicSlot___delitem__);
             if(magic) {
                 if(magic->type == tp_nativefunc) {
                     if(!py_callcfunc(magic->_cfunc, 2, SECOND())) goto __ERROR;
@@ -511,7 +837,7 @@ __NEXT_STEP:
             goto __ERROR;
         }
         /*****************************************/
-        case OP_BUILD_IMAG: {
+        CASE(OP_BUILD_IMAG) {
             // [x]
             py_Ref f = py_getdict(self->builtins, py_name("complex"));
             assert(f != NULL);
@@ -520,10 +846,10 @@ __NEXT_STEP:
             py_newnil(SP()++);     // [complex, NULL]
             py_newint(SP()++, 0);  // [complex, NULL, 0]
             *SP()++ = tmp;         // [complex, NULL, 0, x]
-            vectorcall_opcall(2, 0);
+            vectorcall_opcall(2, 0, NULL);
             DISPATCH();
         }
-        case OP_BUILD_BYTES: {
+        CASE(OP_BUILD_BYTES) {
             int size;
             py_Ref string = c11__at(py_TValue, &frame->co->consts, byte.arg);
             const char* data = py_tostrn(string, &size);
@@ -531,7 +857,7 @@ __NEXT_STEP:
             memcpy(p, data, size);
             DISPATCH();
         }
-        case OP_BUILD_TUPLE: {
+        CASE(OP_BUILD_TUPLE) {
             py_TValue tmp;
             py_Ref p = py_newtuple(&tmp, byte.arg);
             py_TValue* begin = SP() - byte.arg;
@@ -541,7 +867,7 @@ __NEXT_STEP:
             PUSH(&tmp);
             DISPATCH();
         }
-        case OP_BUILD_LIST: {
+        CASE(OP_BUILD_LIST) {
             py_TValue tmp;
             py_newlistn(&tmp, byte.arg);
             py_TValue* begin = SP() - byte.arg;
@@ -552,7 +878,7 @@ __NEXT_STEP:
             PUSH(&tmp);
             DISPATCH();
         }
-        case OP_BUILD_DICT: {
+        CASE(OP_BUILD_DICT) {
             py_TValue* begin = SP() - byte.arg * 2;
             py_Ref tmp = py_pushtmp();
             py_newdict(tmp);
@@ -564,7 +890,7 @@ __NEXT_STEP:
             PUSH(tmp);
             DISPATCH();
         }
-        case OP_BUILD_SET: {
+        CASE(OP_BUILD_SET) {
             py_TValue* begin = SP() - byte.arg;
             py_Ref typeobject_set = py_getdict(self->builtins, py_name("set"));
             assert(typeobject_set != NULL);
@@ -586,7 +912,7 @@ __NEXT_STEP:
             PUSH(&tmp);
             DISPATCH();
         }
-        case OP_BUILD_SLICE: {
+        CASE(OP_BUILD_SLICE) {
             // [start, stop, step]
             py_TValue tmp;
             py_newslice(&tmp);
@@ -597,7 +923,7 @@ __NEXT_STEP:
             PUSH(&tmp);
             DISPATCH();
         }
-        case OP_BUILD_STRING: {
+        CASE(OP_BUILD_STRING) {
             py_TValue* begin = SP() - byte.arg;
             c11_sbuf ss;
             c11_sbuf__ctor(&ss);
@@ -610,9 +936,11 @@ __NEXT_STEP:
             DISPATCH();
         }
         /*****************************/
-#define CASE_BINARY_OP(label, op, rop)                                                             \
-    case label: {                                                                                  \
-        if(!pk_stack_binaryop(self, op, rop)) goto __ERROR;                                        \
+#define CASE_BINARY_OP(label, magic, rmagic)                                                       \
+    CASE(label) {                                                                                  \
+        Opcode spec = pk_specialize_binaryop(label, SECOND()->type, TOP()->type);                  \
+        if(spec != label) co_codes[frame->ip].op = spec;                                           \
+        if(!pk_stack_binaryop(self, magic, rmagic)) goto __ERROR;                                  \
         POP();                                                                                     \
         *TOP() = self->last_retval;                                                                \
         DISPATCH();                                                                                \
@@ -637,16 +965,171 @@ __NEXT_STEP:
             CASE_BINARY_OP(OP_COMPARE_GT, __gt__, __lt__)
             CASE_BINARY_OP(OP_COMPARE_GE, __ge__, __le__)
 #undef CASE_BINARY_OP
-        case OP_IS_OP: {
+/* Quickened variants of the binary ops above. When both operands have type `T` and
+ * `guard` holds, `expr` stores the result into SECOND() using `a` and `b`. Otherwise
+ * the instruction is rewritten back to `generic` and falls back to the generic path. */
+#define CASE_SPECIALIZED_OP(label, generic, magic, rmagic, T, ctype, field, guard, expr)           \
+    CASE(label) {                                                                                  \
+        if(SECOND()->type == T && TOP()->type == T) {                                              \
+            ctype a = SECOND()->field;                                                             \
+            ctype b = TOP()->field;                                                                \
+            if(guard) {                                                                            \
+                expr;                                                                              \
+                POP();                                                                             \
+                DISPATCH();                                                                        \
+            }                                                                                      \
+        }                                                                                          \
+        co_codes[frame->ip].op = generic;                                                          \
+        if(!pk_stack_binaryop(self, magic, rmagic)) goto __ERROR;                                  \
+        POP();                                                                                     \
+        *TOP() = self->last_retval;                                                                \
+        DISPATCH();                                                                                \
+    }
+#define CASE_INT_OP(name, magic, rmagic, guard, expr)                                              \
+    CASE_SPECIALIZED_OP(OP_##name##_INT,                                                           \
+                        OP_##name,                                                                 \
+                        magic,                                                                     \
+                        rmagic,                                                                    \
+                        tp_int,                                                                    \
+                        py_i64,                                                                    \
+                        _i64,                                                                      \
+                        guard,                                                                     \
+                        expr)
+#define CASE_FLOAT_OP(name, magic, rmagic, guard, expr)                                            \
+    CASE_SPECIALIZED_OP(OP_##name##_FLOAT,                                                         \
+                        OP_##name,                                                                 \
+                        magic,                                                                     \
+                        rmagic,                                                                    \
+                        tp_float,                                                                  \
+                        py_f64,                                                                    \
+                        _f64,                                                                      \
+                        guard,                                                                     \
+                        expr)
+            CASE_INT_OP(BINARY_ADD, __add__, __radd__, true, py_newint(SECOND(), a + b))
+            CASE_INT_OP(BINARY_SUB, __sub__, __rsub__, true, py_newint(SECOND(), a - b))
+            CASE_INT_OP(BINARY_MUL, __mul__, __rmul__, true, py_newint(SECOND(), a * b))
+            // negative divisors and division by zero take the generic path
+            CASE_INT_OP(BINARY_FLOORDIV,
+                        __floordiv__,
+                        __rfloordiv__,
+                        b > 0,
+                        py_newint(SECOND(), a / b - (a % b < 0)))
+            CASE_INT_OP(BINARY_MOD,
+                        __mod__,
+                        __rmod__,
+                        b > 0,
+                        py_newint(SECOND(), a % b + (a % b < 0 ? b : 0)))
+            CASE_INT_OP(COMPARE_LT, __lt__, __gt__, true, py_newbool(SECOND(), a < b))
+            CASE_INT_OP(COMPARE_LE, __le__, __ge__, true, py_newbool(SECOND(), a <= b))
+            CASE_INT_OP(COMPARE_EQ, __eq__, __eq__, true, py_newbool(SECOND(), a == b))
+            CASE_INT_OP(COMPARE_NE, __ne__, __ne__, true, py_newbool(SECOND(), a != b))
+            CASE_INT_OP(COMPARE_GT, __gt__, __lt__, true, py_newbool(SECOND(), a > b))
+            CASE_INT_OP(COMPARE_GE, __ge__, __le__, true, py_newbool(SECOND(), a >= b))
+            CASE_FLOAT_OP(BINARY_ADD, __add__, __radd__, true, py_newfloat(SECOND(), a + b))
+            CASE_FLOAT_OP(BINARY_SUB, __sub__, __rsub__, true, py_newfloat(SECOND(), a - b))
+            CASE_FLOAT_OP(BINARY_MUL, __mul__, __rmul__, true, py_newfloat(SECOND(), a * b))
+            CASE_FLOAT_OP(BINARY_TRUEDIV,
+                          __truediv__,
+                          __rtruediv__,
+                          b != 0.0,
+                          py_newfloat(SECOND(), a / b))
+            CASE_FLOAT_OP(COMPARE_LT, __lt__, __gt__, true, py_newbool(SECOND(), a < b))
+            CASE_FLOAT_OP(COMPARE_LE, __le__, __ge__, true, py_newbool(SECOND(), a <= b))
+            CASE_FLOAT_OP(COMPARE_EQ, __eq__, __eq__, true, py_newbool(SECOND(), a == b))
+            CASE_FLOAT_OP(COMPARE_NE, __ne__, __ne__, true, py_newbool(SECOND(), a != b))
+            CASE_FLOAT_OP(COMPARE_GT, __gt__, __lt__, true, py_newbool(SECOND(), a > b))
+            CASE_FLOAT_OP(COMPARE_GE, __ge__, __le__, true, py_newbool(SECOND(), a >= b))
+#undef CASE_FLOAT_OP
+#undef CASE_INT_OP
+#undef CASE_SPECIALIZED_OP
+        /*****************************************/
+        // superinstructions advance `frame->ip` through the fused opcodes one by one,
+        // so that errors are reported at the exact opcode
+        CASE(OP_LOAD_FAST__LOAD_FAST) {
+            py_Ref a = &frame->locals[byte.arg];
+            if(py_isnil(a)) goto __UNBOUND_LOCAL;
+            frame->ip++;
+            byte = co_codes[frame->ip];
+            py_Ref b = &frame->locals[byte.arg];
+            if(py_isnil(b)) goto __UNBOUND_LOCAL;
+            PUSH(a);
+            PUSH(b);
+            DISPATCH();
+        }
+        CASE(OP_LOAD_FAST__LOAD_SMALL_INT) {
+            py_Ref a = &frame->locals[byte.arg];
+            if(py_isnil(a)) goto __UNBOUND_LOCAL;
+            PUSH(a);
+            frame->ip++;
+            py_newint(SP()++, (int16_t)co_codes[frame->ip].arg);
+            DISPATCH();
+        }
+#define CASE_LOAD_FAST_INT_OP(label, op)                                                           \
+    CASE(label) {                                                                                  \
+        py_Ref a = &frame->locals[byte.arg];                                                       \
+        if(py_isnil(a)) goto __UNBOUND_LOCAL;                                                      \
+        py_i64 b = (int16_t)co_codes[frame->ip + 1].arg;                                           \
+        if(a->type == tp_int) {                                                                    \
+            py_newint(SP()++, a->_i64 op b);                                                       \
+            DISPATCH_JUMP(3);                                                                      \
+        }                                                                                          \
+        /* run the binary op at `ip + 2` as usual */                                               \
+        PUSH(a);                                                                                   \
+        py_newint(SP()++, b);                                                                      \
+        DISPATCH_JUMP(2);                                                                          \
+    }
+            CASE_LOAD_FAST_INT_OP(OP_LOAD_FAST__LOAD_SMALL_INT__BINARY_ADD, +)
+            CASE_LOAD_FAST_INT_OP(OP_LOAD_FAST__LOAD_SMALL_INT__BINARY_SUB, -)
+#undef CASE_LOAD_FAST_INT_OP
+        CASE(OP_STORE_FAST__LOAD_FAST) {
+            frame->locals[byte.arg] = POPX();
+            frame->ip++;
+            byte = co_codes[frame->ip];
+            py_Ref b = &frame->locals[byte.arg];
+            if(py_isnil(b)) goto __UNBOUND_LOCAL;
+            PUSH(b);
+            DISPATCH();
+        }
+#define CASE_COMPARE_JUMP(label, op, magic, rmagic)                                                \
+    CASE(label) {                                                                                  \
+        int res;                                                                                   \
+        if(SECOND()->type == tp_int && TOP()->type == tp_int) {                                    \
+            res = SECOND()->_i64 op TOP()->_i64;                                                   \
+        } else if(SECOND()->type == tp_float && TOP()->type == tp_float) {                         \
+            res = SECOND()->_f64 op TOP()->_f64;                                                   \
+        } else {                                                                                   \
+            if(!pk_stack_binaryop(self, magic, rmagic)) goto __ERROR;                              \
+            POP();                                                                                 \
+            *TOP() = self->last_retval;                                                            \
+            frame->ip++;                                                                           \
+            res = py_bool(TOP());                                                                  \
+            if(res < 0) goto __ERROR;                                                              \
+            POP();                                                                                 \
+            if(!res) DISPATCH_JUMP((int16_t)co_codes[frame->ip].arg);                              \
+            DISPATCH();                                                                            \
+        }                                                                                          \
+        STACK_SHRINK(2);                                                                           \
+        frame->ip++;                                                                               \
+        if(!res) DISPATCH_JUMP((int16_t)co_codes[frame->ip].arg);                                  \
+        DISPATCH();                                                                                \
+    }
+            CASE_COMPARE_JUMP(OP_COMPARE_LT__POP_JUMP_IF_FALSE, <, __lt__, __gt__)
+            CASE_COMPARE_JUMP(OP_COMPARE_LE__POP_JUMP_IF_FALSE, <=, __le__, __ge__)
+            CASE_COMPARE_JUMP(OP_COMPARE_EQ__POP_JUMP_IF_FALSE, ==, __eq__, __eq__)
+            CASE_COMPARE_JUMP(OP_COMPARE_NE__POP_JUMP_IF_FALSE, !=, __ne__, __ne__)
+            CASE_COMPARE_JUMP(OP_COMPARE_GT__POP_JUMP_IF_FALSE, >, __gt__, __lt__)
+            CASE_COMPARE_JUMP(OP_COMPARE_GE__POP_JUMP_IF_FALSE, >=, __ge__, __le__)
+#undef CASE_COMPARE_JUMP
+        CASE(OP_IS_OP) {
             bool res = py_isidentical(SECOND(), TOP());
             POP();
             if(byte.arg) res = !res;
             py_newbool(TOP(), res);
             DISPATCH();
         }
-        case OP_CONTAINS_OP: {
+        CASE(OP_CONTAINS_OP) {
             // [b, a] -> b __contains__ a (a in b) -> [retval]
-            py_Ref magic = py_tpfindmagic(SECOND()->type, __contains__);
+            py_Ref magic = pk_tpfindmagicslot(pk_typeinfo(SECOND()->type), MagicSlot___contains__);
             if(magic) {
                 if(magic->type == tp_nativefunc) {
                     if(!py_callcfunc(magic->_cfunc, 2, SECOND())) goto __ERROR;
@@ -665,29 +1148,36 @@ __NEXT_STEP:
             goto __ERROR;
         }
             /*****************************************/
-        case OP_JUMP_FORWARD: DISPATCH_JUMP((int16_t)byte.arg);
-        case OP_POP_JUMP_IF_NOT_MATCH: {
+        CASE(OP_JUMP_FORWARD) {
+            // loops jump back to their head with a negative offset
+            if((int16_t)byte.arg < 0) {
+                SELECT_LOOP();
+                BURN_FUEL(-(int16_t)byte.arg);
+            }
+            DISPATCH_JUMP((int16_t)byte.arg);
+        }
+        CASE(OP_POP_JUMP_IF_NOT_MATCH) {
             int res = py_equal(SECOND(), TOP());
             if(res < 0) goto __ERROR;
             STACK_SHRINK(2);
             if(!res) DISPATCH_JUMP((int16_t)byte.arg);
             DISPATCH();
         }
-        case OP_POP_JUMP_IF_FALSE: {
+        CASE(OP_POP_JUMP_IF_FALSE) {
             int res = py_bool(TOP());
             if(res < 0) goto __ERROR;
             POP();
             if(!res) DISPATCH_JUMP((int16_t)byte.arg);
             DISPATCH();
         }
-        case OP_POP_JUMP_IF_TRUE: {
+        CASE(OP_POP_JUMP_IF_TRUE) {
             int res = py_bool(TOP());
             if(res < 0) goto __ERROR;
             POP();
             if(res) DISPATCH_JUMP((int16_t)byte.arg);
             DISPATCH();
         }
-        case OP_JUMP_IF_TRUE_OR_POP: {
+        CASE(OP_JUMP_IF_TRUE_OR_POP) {
             int res = py_bool(TOP());
             if(res < 0) goto __ERROR;
             if(res) {
@@ -697,7 +1187,7 @@ __NEXT_STEP:
                 DISPATCH();
             }
         }
-        case OP_JUMP_IF_FALSE_OR_POP: {
+        CASE(OP_JUMP_IF_FALSE_OR_POP) {
             int res = py_bool(TOP());
             if(res < 0) goto __ERROR;
             if(!res) {
@@ -707,7 +1197,7 @@ __NEXT_STEP:
                 DISPATCH();
             }
         }
-        case OP_SHORTCUT_IF_FALSE_OR_POP: {
+        CASE(OP_SHORTCUT_IF_FALSE_OR_POP) {
             int res = py_bool(TOP());
             if(res < 0) goto __ERROR;
             if(!res) {                      // [b, False]
@@ -719,19 +1209,22 @@ __NEXT_STEP:
                 DISPATCH();
             }
         }
-        case OP_LOOP_CONTINUE: {
+        CASE(OP_LOOP_CONTINUE) {
+            SELECT_LOOP();
+            BURN_FUEL(-(int16_t)byte.arg);
             DISPATCH_JUMP((int16_t)byte.arg);
         }
-        case OP_LOOP_BREAK: {
+        CASE(OP_LOOP_BREAK) {
             DISPATCH_JUMP((int16_t)byte.arg);
         }
         /*****************************************/
-        case OP_CALL: {
+        CASE(OP_CALL) {
             ManagedHeap__collect_if_needed(&self->heap);
-            vectorcall_opcall(byte.arg & 0xFF, byte.arg >> 8);
+            uint16_t kwargc = byte.arg >> 8;
+            vectorcall_opcall(byte.arg & 0xFF, kwargc, kwargc ? CALL_CACHE() : NULL);
             DISPATCH();
         }
-        case OP_CALL_VARGS: {
+        CASE(OP_CALL_VARGS) {
             // [_0, _1, _2 | k1, v1, k2, v2]
             uint16_t argc = byte.arg & 0xFF;
             uint16_t kwargc = byte.arg >> 8;
@@ -783,10 +1276,10 @@ __NEXT_STEP:
             memcpy(base, buf, n * sizeof(py_TValue));
             SP() = base + n;
 
-            vectorcall_opcall(argc, kwargc);
+            vectorcall_opcall(argc, kwargc, NULL);
             DISPATCH();
         }
-        case OP_RETURN_VALUE: {
+        CASE(OP_RETURN_VALUE) {
             CHECK_RETURN_FROM_EXCEPT_OR_FINALLY();
             if(byte.arg == BC_NOARG) {
                 self->last_retval = POPX();
@@ -803,7 +1296,7 @@ __NEXT_STEP:
             }
             DISPATCH();
         }
-        case OP_YIELD_VALUE: {
+        CASE(OP_YIELD_VALUE) {
             CHECK_RETURN_FROM_EXCEPT_OR_FINALLY();
             if(byte.arg == 1) {
                 py_newnone(py_retval());
@@ -813,8 +1306,16 @@ __NEXT_STEP:
             }
             return RES_YIELD;
         }
-        case OP_FOR_ITER_YIELD_VALUE: {
+        CASE(OP_FOR_ITER_YIELD_VALUE) {
             CHECK_RETURN_FROM_EXCEPT_OR_FINALLY();
+            if(TOP()->type == tp_generator) {
+                // `yield from` a generator: take its return value without `StopIteration`
+                int res = pk_generator_resume(TOP());
+                if(res == -1) goto __ERROR;
+                if(res) return RES_YIELD;
+                *TOP() = self->last_retval;  // [iter] -> [retval]
+                DISPATCH_JUMP((int16_t)byte.arg);
+            }
             int res = py_next(TOP());
             if(res == -1) goto __ERROR;
             if(res) {
@@ -829,20 +1330,20 @@ __NEXT_STEP:
             }
         }
         /////////
-        case OP_LIST_APPEND: {
+        CASE(OP_LIST_APPEND) {
             // [list, iter, value]
             py_list_append(THIRD(), TOP());
             POP();
             DISPATCH();
         }
-        case OP_DICT_ADD: {
+        CASE(OP_DICT_ADD) {
             // [dict, iter, key, value]
             bool ok = py_dict_setitem(FOURTH(), SECOND(), TOP());
             if(!ok) goto __ERROR;
             STACK_SHRINK(2);
             DISPATCH();
         }
-        case OP_SET_ADD: {
+        CASE(OP_SET_ADD) {
             // [set, iter, value]
             py_push(THIRD());  // [| set]
             if(!py_pushmethod(py_name("add"))) {
@@ -854,49 +1355,137 @@ __NEXT_STEP:
             DISPATCH();
         }
         /////////
-        case OP_UNARY_NEGATIVE: {
+        CASE(OP_UNARY_NEGATIVE) {
             if(!pk_callmagic(__neg__, 1, TOP())) goto __ERROR;
             *TOP() = self->last_retval;
             DISPATCH();
         }
-        case OP_UNARY_NOT: {
+        CASE(OP_UNARY_NOT) {
             int res = py_bool(TOP());
             if(res < 0) goto __ERROR;
             py_newbool(TOP(), !res);
             DISPATCH();
         }
-        case OP_UNARY_STAR: {
+        CASE(OP_UNARY_STAR) {
             py_TValue value = POPX();
             int* level = py_newobject(SP()++, tp_star_wrapper, 1, sizeof(int));
             *level = byte.arg;
             py_setslot(TOP(), 0, &value);
             DISPATCH();
         }
-        case OP_UNARY_INVERT: {
+        CASE(OP_UNARY_INVERT) {
             if(!pk_callmagic(__invert__, 1, TOP())) goto __ERROR;
             *TOP() = self->last_retval;
             DISPATCH();
         }
         ////////////////
-        case OP_GET_ITER: {
+        CASE(OP_GET_ITER) {
+            // `for` loops over builtin containers keep their state in the iterator slot
+            Bytecode* loop = &co_codes[frame->ip + 1];
+            if(loop->op == OP_FOR_ITER || pk_for_iter_op(loop->op) != OP_FOR_ITER) {
+                if(pk_unbox_iterable(TOP())) {
+                    loop->op = pk_for_iter_op(TOP()->type);
+                    DISPATCH();
+                }
+            }
             if(!py_iter(TOP())) goto __ERROR;
             *TOP() = *py_retval();
             DISPATCH();
         }
-        case OP_FOR_ITER: {
-            int res = py_next(TOP());
+        CASE(OP_FOR_ITER) {
+            if(pk_for_iter_op(TOP()->type) != OP_FOR_ITER) {
+                co_codes[frame->ip].op = pk_for_iter_op(TOP()->type);
+                goto __NEXT_STEP;
+            }
+            int res = TOP()->type == tp_generator ? pk_generator_resume(TOP()) : py_next(TOP());
             if(res == -1) goto __ERROR;
             if(res) {
                 PUSH(py_retval());
                 DISPATCH();
             } else {
-                assert(self->last_retval.type == tp_StopIteration);
                 POP();  // [iter] -> []
                 DISPATCH_JUMP((int16_t)byte.arg);
             }
         }
+// another frame of the same code may have left a different loop state in the slot
+#define FOR_ITER_GUARD(T)                                                                          \
+    if(TOP()->type != T) {                                                                         \
+        co_codes[frame->ip].op = pk_for_iter_op(TOP()->type);                                      \
+        goto __NEXT_STEP;                                                                          \
+    }
+        CASE(OP_FOR_ITER_RANGE) {
+            FOR_ITER_GUARD(tp_for_range);
+            py_TValue* it = TOP();
+            py_i64 curr = pk_forrange_curr(it);
+            py_i64 stop = pk_forrange_stop(it);
+            if(it->extra > 0 ? curr < stop : curr > stop) {
+                pk_forrange_setcurr(it, curr + it->extra);
+                py_newint(SP(), curr);
+                SP()++;
+                DISPATCH();
+            }
+            POP();
+            DISPATCH_JUMP((int16_t)byte.arg);
+        }
+        CASE(OP_FOR_ITER_LIST) {
+            FOR_ITER_GUARD(tp_for_list);
+            py_TValue* it = TOP();
+            List* list = PyObject__userdata(it->_obj);
+            if(it->extra < list->length) {
+                PUSH(c11__at(py_TValue, list, it->extra++));
+                DISPATCH();
+            }
+            POP();
+            DISPATCH_JUMP((int16_t)byte.arg);
+        }
+        CASE(OP_FOR_ITER_TUPLE) {
+            FOR_ITER_GUARD(tp_for_tuple);
+            py_TValue* it = TOP();
+            if(it->extra < it->_obj->slots) {
+                PUSH(PyObject__slots(it->_obj) + it->extra++);
+                DISPATCH();
+            }
+            POP();
+            DISPATCH_JUMP((int16_t)byte.arg);
+        }
+        CASE(OP_FOR_ITER_STR) {
+            FOR_ITER_GUARD(tp_for_str);
+            py_TValue* it = TOP();
+            c11_string* str = PyObject__userdata(it->_obj);
+            if(it->extra < str->size) {
+                int start = it->extra;
+                int len = c11__u8_header(str->data[start], false);
+                it->extra += len;
+                py_newstrv(SP(), (c11_sv){str->data + start, len});
+                SP()++;
+                DISPATCH();
+            }
+            POP();
+            DISPATCH_JUMP((int16_t)byte.arg);
+        }
+        CASE(OP_FOR_ITER_DICT) {
+            FOR_ITER_GUARD(tp_for_dict);
+            py_TValue* it = TOP();
+            Dict* dict = PyObject__userdata(it->_obj);
+#if !PK_ENABLE_COMPACT_TVALUE
+            // dicts are never unboxed in compact mode
+            if(dict->version != pk_forstate_hi(it)) {
+                RuntimeError("dictionary modified during iteration");
+                goto __ERROR;
+            }
+#endif
+            while(it->extra < dict->entries.length) {
+                DictEntry* entry = c11__at(DictEntry, &dict->entries, it->extra++);
+                if(py_isnil(&entry->key)) continue;
+                PUSH(&entry->key);
+                DISPATCH();
+            }
+            POP();
+            DISPATCH_JUMP((int16_t)byte.arg);
+        }
+#undef FOR_ITER_GUARD
         ////////
-        case OP_IMPORT_PATH: {
+        CASE(OP_IMPORT_PATH) {
             py_Ref path_object = c11__at(py_TValue, &frame->co->consts, byte.arg);
             const char* path = py_tostr(path_object);
             int res = py_import(path);
@@ -908,7 +1497,7 @@ __NEXT_STEP:
             PUSH(py_retval());
             DISPATCH();
         }
-        case OP_POP_IMPORT_STAR: {
+        CASE(OP_POP_IMPORT_STAR) {
             // [module]
             NameDict* dict = PyObject__dict(TOP()->_obj);
             py_ItemRef all = NameDict__try_get(dict, __all__);
@@ -942,7 +1531,7 @@ __NEXT_STEP:
             DISPATCH();
         }
         ////////
-        case OP_UNPACK_SEQUENCE: {
+        CASE(OP_UNPACK_SEQUENCE) {
             py_TValue* p;
             int length;
 
@@ -1010,7 +1599,7 @@ __NEXT_STEP:
             }
             DISPATCH();
         }
-        case OP_UNPACK_EX: {
+        CASE(OP_UNPACK_EX) {
             py_TValue* p;
             int length = pk_arrayview(TOP(), &p);
             if(length == -1) {
@@ -1033,7 +1622,7 @@ __NEXT_STEP:
             DISPATCH();
         }
         ///////////
-        case OP_BEGIN_CLASS: {
+        CASE(OP_BEGIN_CLASS) {
             // [base]
             py_Name name = co_names[byte.arg];
             py_Type base;
@@ -1062,7 +1651,7 @@ __NEXT_STEP:
             self->curr_class = TOP();
             DISPATCH();
         }
-        case OP_END_CLASS: {
+        CASE(OP_END_CLASS) {
             // [cls or decorated]
             py_Name name = co_names[byte.arg];
             if(!Frame__setglobal(frame, name, TOP())) goto __ERROR;
@@ -1087,7 +1676,7 @@ __NEXT_STEP:
             self->curr_class = NULL;
             DISPATCH();
         }
-        case OP_STORE_CLASS_ATTR: {
+        CASE(OP_STORE_CLASS_ATTR) {
             assert(self->curr_class);
             py_Name name = co_names[byte.arg];
             // TOP() can be a function, classmethod or custom decorator
@@ -1101,7 +1690,7 @@ __NEXT_STEP:
             POP();
             DISPATCH();
         }
-        case OP_ADD_CLASS_ANNOTATION: {
+        CASE(OP_ADD_CLASS_ANNOTATION) {
             assert(self->curr_class);
             // [type_hint string]
             py_TypeInfo* ti = py_touserdata(self->curr_class);
@@ -1113,17 +1702,17 @@ __NEXT_STEP:
             DISPATCH();
         }
         ///////////
-        case OP_WITH_ENTER: {
+        CASE(OP_WITH_ENTER) {
             // [expr]
             py_push(TOP());
             if(!py_pushmethod(__enter__)) {
                 TypeError("'%t' object does not support the context manager protocol", TOP()->type);
                 goto __ERROR;
             }
-            vectorcall_opcall(0, 0);
+            vectorcall_opcall(0, 0, NULL);
             DISPATCH();
         }
-        case OP_WITH_EXIT: {
+        CASE(OP_WITH_EXIT) {
             // [expr]
             py_push(TOP());
             if(!py_pushmethod(__exit__)) {
@@ -1135,17 +1724,13 @@ __NEXT_STEP:
             DISPATCH();
         }
         ///////////
-        case OP_TRY_ENTER: {
-            Frame__set_unwind_target(frame, SP());
-            DISPATCH();
-        }
-        case OP_EXCEPTION_MATCH: {
+        CASE(OP_EXCEPTION_MATCH) {
             if(!py_checktype(TOP(), tp_type)) goto __ERROR;
             bool ok = py_isinstance(&self->curr_exception, py_totype(TOP()));
             py_newbool(TOP(), ok);
             DISPATCH();
         }
-        case OP_RAISE: {
+        CASE(OP_RAISE) {
             // [exception]
             if(py_istype(TOP(), tp_type)) {
                 if(!py_tpcall(py_totype(TOP()), 0, NULL)) goto __ERROR;
@@ -1158,7 +1743,7 @@ __NEXT_STEP:
             py_raise(TOP());
             goto __ERROR;
         }
-        case OP_RAISE_ASSERT: {
+        CASE(OP_RAISE_ASSERT) {
             if(byte.arg) {
                 if(!py_str(TOP())) goto __ERROR;
                 POP();
@@ -1168,29 +1753,29 @@ __NEXT_STEP:
             }
             goto __ERROR;
         }
-        case OP_RE_RAISE: {
+        CASE(OP_RE_RAISE) {
             if(self->curr_exception.type) {
                 assert(!self->is_curr_exc_handled);
                 goto __ERROR_RE_RAISE;
             }
             DISPATCH();
         }
-        case OP_PUSH_EXCEPTION: {
+        CASE(OP_PUSH_EXCEPTION) {
             assert(self->curr_exception.type);
             PUSH(&self->curr_exception);
             DISPATCH();
         }
-        case OP_BEGIN_EXC_HANDLING: {
+        CASE(OP_BEGIN_EXC_HANDLING) {
             assert(self->curr_exception.type);
             self->is_curr_exc_handled = true;
             DISPATCH();
         }
-        case OP_END_EXC_HANDLING: {
+        CASE(OP_END_EXC_HANDLING) {
             assert(self->curr_exception.type);
             py_clearexc(NULL);
             DISPATCH();
         }
-        case OP_BEGIN_FINALLY: {
+        CASE(OP_BEGIN_FINALLY) {
             if(self->curr_exception.type) {
                 assert(!self->is_curr_exc_handled);
                 // temporarily handle the exception if any
@@ -1198,7 +1783,7 @@ __NEXT_STEP:
             }
             DISPATCH();
         }
-        case OP_END_FINALLY: {
+        CASE(OP_END_FINALLY) {
             if(byte.arg == BC_NOARG) {
                 if(self->curr_exception.type) {
                     assert(self->is_curr_exc_handled);
@@ -1212,7 +1797,7 @@ __NEXT_STEP:
             DISPATCH();
         }
         //////////////////
-        case OP_FORMAT_STRING: {
+        CASE(OP_FORMAT_STRING) {
             py_Ref spec = c11__at(py_TValue, &frame->co->consts, byte.arg);
             bool ok = stack_format_object(self, py_tosv(spec));
             if(!ok) goto __ERROR;
@@ -1224,11 +1809,7 @@ __NEXT_STEP:
     c11__unreachable();
 
 __ERROR:
-    py_BaseException__stpush(frame,
-                             &self->curr_exception,
-                             frame->co->src,
-                             Frame__lineno(frame),
-                             !frame->is_locals_special ? frame->co->name->data : NULL);
+    py_BaseException__stpush(frame, &self->curr_exception);
 __ERROR_RE_RAISE:
     do {
     } while(0);
@@ -1236,6 +1817,7 @@ __ERROR_RE_RAISE:
     int target = Frame__prepare_jump_exception_handler(frame, &self->stack);
     if(target >= 0) {
         // 1. Exception can be handled inside the current frame
+        SELECT_LOOP();
         DISPATCH_JUMP_ABSOLUTE(target);
     } else {
         // 2. Exception need to be propagated to the upper frame
@@ -1518,6 +2100,12 @@ static bool stack_format_object(VM* self, c11_sv spec) {
 }
 
 #undef CHECK_RETURN_FROM_EXCEPT_OR_FINALLY
+#undef PK_USE_COMPUTED_GOTO
+#undef STEP_HOOKS_ACTIVE
+#undef CASE
+#undef GOTO_NEXT_STEP
+#undef SELECT_LOOP
+#undef BURN_FUEL
 #undef DISPATCH
 #undef DISPATCH_JUMP
 #undef DISPATCH_JUMP_ABSOLUTE
@@ -1534,6 +2122,8 @@ static bool stack_format_object(VM* self, c11_sv spec) {
 #undef INSERT_THIRD
 #undef vectorcall_opcall
 #undef RESET_CO_CACHE
+#undef ATTR_CACHE
+#undef GLOBAL_CACHE
 
 void py_sys_settrace(py_TraceFunc func, bool reset) {
     TraceInfo* info = &pk_current_vm->trace_info;
@@ -29,37 +29,27 @@ void FastLocals__to_dict(py_TValue* locals, const CodeObject* co) {
     py_pop();
 }
 
-NameDict* FastLocals__to_namedict(py_TValue* locals, const CodeObject* co) {
-    NameDict* dict = NameDict__new(PK_INST_ATTR_LOAD_FACTOR);
-    c11__foreach(c11_smallmap_n2d_KV, &co->varnames_inv, entry) {
-        py_Ref val = &locals[entry->value];
-        if(!py_isnil(val)) NameDict__set(dict, entry->key, val);
-    }
-    return dict;
+void FrameStack__ctor(FrameStack* self) {
+    self->sp = self->begin;
+    self->end = self->begin + PK_VM_FRAME_STACK_SIZE;
 }
 
-UnwindTarget* UnwindTarget__new(UnwindTarget* next, int iblock, int offset) {
-    UnwindTarget* self = PK_MALLOC(sizeof(UnwindTarget));
-    self->next = next;
-    self->iblock = iblock;
-    self->offset = offset;
-    return self;
+static bool FrameStack__contains(FrameStack* self, py_Frame* frame) {
+    return frame >= self->begin && frame < self->end;
 }
 
-void UnwindTarget__delete(UnwindTarget* self) { PK_FREE(self); }
-
-py_Frame* Frame__new(const CodeObject* co,
-                     py_StackRef p0,
-                     py_GlobalRef module,
-                     py_Ref globals,
-                     py_Ref locals,
-                     bool is_locals_special) {
+static void Frame__init(py_Frame* self,
+                        const CodeObject* co,
+                        py_StackRef p0,
+                        py_GlobalRef module,
+                        py_Ref globals,
+                        py_Ref locals,
+                        bool is_locals_special) {
     assert(module->type == tp_module);
     assert(globals->type == tp_module || globals->type == tp_dict);
     if(is_locals_special) {
         assert(locals->type == tp_nil || locals->type == tp_locals || locals->type == tp_dict);
     }
-    py_Frame* self = FixedMemoryPool__alloc(&pk_current_vm->pool_frame);
     self->f_back = NULL;
     self->co = co;
     self->p0 = p0;
@@ -68,51 +58,58 @@ py_Frame* Frame__new(const CodeObject* co,
     self->locals = locals;
     self->is_locals_special = is_locals_special;
     self->ip = -1;
-    self->uw_list = NULL;
+}
+
+py_Frame* Frame__new(const CodeObject* co,
+                     py_StackRef p0,
+                     py_GlobalRef module,
+                     py_Ref globals,
+                     py_Ref locals,
+                     bool is_locals_special) {
+    FrameStack* fs = &pk_current_vm->frame_stack;
+    py_Frame* self = fs->sp < fs->end ? fs->sp++ : PK_MALLOC(sizeof(py_Frame));
+    Frame__init(self, co, p0, module, globals, locals, is_locals_special);
     return self;
 }
 
-void Frame__delete(py_Frame* self) {
-    while(self->uw_list) {
-        UnwindTarget* p = self->uw_list;
-        self->uw_list = p->next;
-        UnwindTarget__delete(p);
-    }
-    FixedMemoryPool__dealloc(&pk_current_vm->pool_frame, self);
+py_Frame* Frame__new_detached(const CodeObject* co,
+                              py_StackRef p0,
+                              py_GlobalRef module,
+                              py_Ref globals,
+                              py_Ref locals) {
+    py_Frame* self = PK_MALLOC(sizeof(py_Frame));
+    Frame__init(self, co, p0, module, globals, locals, false);
+    return self;
 }
 
-int Frame__prepare_jump_exception_handler(py_Frame* self, ValueStack* _s) {
-    // try to find a parent try block
-    int iblock = Frame__iblock(self);
-    while(iblock >= 0) {
-        CodeBlock* block = c11__at(CodeBlock, &self->co->blocks, iblock);
-        if(block->type == CodeBlockType_TRY) break;
-        iblock = block->parent;
+void Frame__delete(py_Frame* self) {
+    FrameStack* fs = &pk_current_vm->frame_stack;
+    if(FrameStack__contains(fs, self)) {
+        // frames on the frame stack are always released in LIFO order
+        assert(self == fs->sp - 1);
+        fs->sp = self;
+    } else {
+        PK_FREE(self);
     }
-    if(iblock < 0) return -1;
-    UnwindTarget* uw = Frame__find_unwind_target(self, iblock);
-    _s->sp = (self->p0 + uw->offset);  // unwind the stack
-    return c11__at(CodeBlock, &self->co->blocks, iblock)->end;
 }
 
-UnwindTarget* Frame__find_unwind_target(py_Frame* self, int iblock) {
-    UnwindTarget* uw;
-    for(uw = self->uw_list; uw; uw = uw->next) {
-        if(uw->iblock == iblock) return uw;
-    }
-    return NULL;
+py_StackRef Frame__stack_base(py_Frame* self) {
+    // a function frame starts with its locals on the stack
+    if(self->is_locals_special) return self->p0;
+    return self->locals + self->co->nlocals;
 }
 
-void Frame__set_unwind_target(py_Frame* self, py_TValue* sp) {
-    int iblock = Frame__iblock(self);
-    assert(iblock >= 0);
-    UnwindTarget* existing = Frame__find_unwind_target(self, iblock);
-    if(existing) {
-        existing->offset = sp - self->p0;
-    } else {
-        UnwindTarget* prev = self->uw_list;
-        self->uw_list = UnwindTarget__new(prev, iblock, sp - self->p0);
+int Frame__prepare_jump_exception_handler(py_Frame* self, ValueStack* _s) {
+    const c11_vector* table = &self->co->exc_handlers;
+    // the innermost try block enclosing `ip` was entered last
+    for(int i = table->length - 1; i >= 0; i--) {
+        ExceptionHandler* h = c11__at(ExceptionHandler, table, i);
+        if(self->ip < h->start || self->ip >= h->end) continue;
+        py_TValue* base = Frame__stack_base(self);
+        _s->sp = base + h->depth;  // unwind the stack
+        return h->target;
     }
+    return -1;
 }
 
 void Frame__gc_mark(py_Frame* self, c11_vector* p_stack) {
@@ -175,14 +172,6 @@ py_StackRef Frame__getlocal_noproxy(py_Frame* self, py_Name name) {
     return &self->locals[index];
 }
 
-py_Ref Frame__getclosure(py_Frame* self, py_Name name) {
-    if(self->is_locals_special) return NULL;
-    assert(self->p0->type == tp_function);
-    Function* ud = py_touserdata(self->p0);
-    if(ud->closure == NULL) return NULL;
-    return NameDict__try_get(ud->closure, name);
-}
-
 SourceLocation Frame__source_location(py_Frame* self) {
     SourceLocation loc;
     loc.lineno = Frame__lineno(self);
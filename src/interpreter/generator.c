@@ -5,42 +5,60 @@
 #include "pocketpy/pocketpy.h"
 #include <stdbool.h>
 #include <assert.h>
+#include <string.h>
+
+static void Generator__save(Generator* ud, py_TValue* begin, py_TValue* end) {
+    int length = end - begin;
+    if(length > ud->backup_capacity) {
+        int capacity = c11__max(length, ud->backup_capacity * 2);
+        ud->backup = PK_REALLOC(ud->backup, sizeof(py_TValue) * capacity);
+        ud->backup_capacity = capacity;
+    }
+    memcpy(ud->backup, begin, sizeof(py_TValue) * length);
+    ud->backup_length = length;
+}
 
 void pk_newgenerator(py_Ref out, py_Frame* frame, py_TValue* begin, py_TValue* end) {
-    Generator* ud = py_newobject(out, tp_generator, 1, sizeof(Generator));
+    Generator* ud = py_newobject(out, tp_generator, 0, sizeof(Generator));
     ud->frame = frame;
     ud->state = 0;
-    py_Ref tmp = py_getslot(out, 0);
-    py_newlist(tmp);
-    for(py_TValue* p = begin; p != end; p++) {
-        py_list_append(tmp, p);
-    }
+    ud->backup = NULL;
+    ud->backup_length = 0;
+    ud->backup_capacity = 0;
+    Generator__save(ud, begin, end);
 }
 
 void Generator__dtor(Generator* ud) {
     if(ud->frame) Frame__delete(ud->frame);
+    PK_FREE(ud->backup);
 }
 
-bool generator__next__(int argc, py_Ref argv) {
-    PY_CHECK_ARGC(1);
-    Generator* ud = py_touserdata(argv);
+void Generator__gc_mark(Generator* ud, c11_vector* p_stack) {
+    if(ud->frame) Frame__gc_mark(ud->frame, p_stack);
+    for(int i = 0; i < ud->backup_length; i++) {
+        pk__mark_value(&ud->backup[i]);
+    }
+}
+
+int pk_generator_resume(py_Ref self) {
+    Generator* ud = py_touserdata(self);
     py_StackRef p0 = py_peek(0);
     VM* vm = pk_current_vm;
-    if(ud->state == 2) return StopIteration();
+    if(ud->state == 2) {
+        py_newnone(py_retval());
+        return 0;
+    }
 
     // reset frame->p0
     assert(!ud->frame->is_locals_special);
     int locals_offset = ud->frame->locals - ud->frame->p0;
     ud->frame->p0 = py_peek(0);
     ud->frame->locals = ud->frame->p0 + locals_offset;
-    
+
     // restore the context
-    py_Ref backup = py_getslot(argv, 0);
-    int length = py_list_len(backup);
-    py_TValue* p = py_list_data(backup);
-    for(int i = 0; i < length; i++)
-        py_push(&p[i]);
-    py_list_clear(backup);
+    memcpy(vm->stack.sp, ud->backup, sizeof(py_TValue) * ud->backup_length);
+    vm->stack.sp += ud->backup_length;
+    ud->backup_length = 0;
 
     // push frame
     VM__push_frame(vm, ud->frame);
@@ -52,32 +70,39 @@ bool generator__next__(int argc, py_Ref argv) {
         ud->state = 2;  // end this generator immediately on error
         if(py_matchexc(tp_StopIteration)) {
             py_clearexc(p0);
-            return true;
+            return 1;
         }
-        return false;
+        return -1;
     }
 
     if(res == RES_YIELD) {
         // backup the context
         ud->frame = vm->top_frame;
-        for(py_StackRef p = ud->frame->p0; p != vm->stack.sp; p++) {
-            py_list_append(backup, p);
-        }
+        Generator__save(ud, ud->frame->p0, vm->stack.sp);
+        pk__write_barrier(self->_obj);
         vm->stack.sp = ud->frame->p0;
         vm->top_frame = vm->top_frame->f_back;
         vm->recursion_depth--;
         ud->state = 1;
-        return true;
+        return 1;
     } else {
         assert(res == RES_RETURN);
         ud->state = 2;
-        // raise StopIteration(<retval>)
-        bool ok = py_tpcall(tp_StopIteration, 1, py_retval());
-        if(!ok) return false;
-        return py_raise(py_retval());
+        return 0;
     }
 }
 
+bool generator__next__(int argc, py_Ref argv) {
+    PY_CHECK_ARGC(1);
+    int res = pk_generator_resume(argv);
+    if(res == -1) return false;
+    if(res == 1) return true;
+    // raise StopIteration(<retval>)
+    bool ok = py_tpcall(tp_StopIteration, 1, py_retval());
+    if(!ok) return false;
+    return py_raise(py_retval());
+}
+
 py_Type pk_generator__register() {
     py_Type type = pk_newtype("generator", tp_object, NULL, (py_Dtor)Generator__dtor, false, true);
     py_bindmagic(type, __iter__, pk_wrapper__self);
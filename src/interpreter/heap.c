@@ -1,14 +1,43 @@
 #include "pocketpy/interpreter/heap.h"
 #include "pocketpy/config.h"
+#include "pocketpy/interpreter/vm.h"
+#include "pocketpy/interpreter/modules.h"
 #include "pocketpy/interpreter/objectpool.h"
 #include "pocketpy/objects/base.h"
 #include "pocketpy/pocketpy.h"
 #include <assert.h>
+#include <string.h>
+
+// objects allocated between two automatic incremental steps
+#define kGCStepInterval c11__max(PK_GC_MIN_THRESHOLD / 8, 1)
+// work units done by an automatic incremental step per allocated object
+#define kGCStepMul 8
+// work units done between two clock checks of `ManagedHeap__step`
+#define kGCStepWork 1024
+
+static int ManagedHeap__sweep_large(ManagedHeap* self, bool young_only);
 
 void ManagedHeap__ctor(ManagedHeap* self) {
     MultiPool__ctor(&self->small_objects);
     c11_vector__ctor(&self->large_objects, sizeof(PyObject*));
     c11_vector__ctor(&self->gc_roots, sizeof(PyObject*));
+    c11_vector__ctor(&self->remembered, sizeof(PyObject*));
+    c11_vector__ctor(&self->frozen_roots, sizeof(PyObject*));
+    self->frozen_count = 0;
+#if PK_ENABLE_GENERATIONAL_GC
+    self->large_old_length = 0;
+    self->promoted = 0;
+    self->survived = 0;
+#endif
+#if PK_ENABLE_PARALLEL_MARK
+    self->mark_workers = NULL;
+#endif
+    self->gc_phase = GCPhase_IDLE;
+    self->gc_marked = 0;
+    self->gc_freed = 0;
+    memset(self->gc_stats, 0, sizeof(self->gc_stats));
+    self->gc_stats_count = 0;
+    self->gc_in_callbacks = false;
 
     for(int i = 0; i < c11__count_array(self->freed_ma); i++) {
         self->freed_ma[i] = PK_GC_MIN_THRESHOLD;
@@ -19,6 +48,9 @@ void ManagedHeap__ctor(ManagedHeap* self) {
 }
 
 void ManagedHeap__dtor(ManagedHeap* self) {
+#if PK_ENABLE_PARALLEL_MARK
+    ManagedHeap__stop_mark_workers(self);
+#endif
     // small_objects
     MultiPool__dtor(&self->small_objects);
     // large_objects
@@ -29,12 +61,22 @@ void ManagedHeap__dtor(ManagedHeap* self) {
     }
     c11_vector__dtor(&self->large_objects);
     c11_vector__dtor(&self->gc_roots);
+    c11_vector__dtor(&self->remembered);
+    c11_vector__dtor(&self->frozen_roots);
 }
 
-void ManagedHeap__collect_if_needed(ManagedHeap* self) {
-    if(!self->gc_enabled) return;
-    if(self->gc_counter < self->gc_threshold) return;
-    int freed = ManagedHeap__collect(self);
+void ManagedHeap__remember(PyObject* obj) {
+    ManagedHeap* self = &pk_current_vm->heap;
+    obj->gc_remembered = true;
+    c11_vector__push(PyObject*, &self->remembered, obj);
+    // frozen objects are never traversed, so a written one keeps its children alive from now on
+    if(!obj->gc_frozen_root && PyObject__is_frozen(obj)) {
+        obj->gc_frozen_root = true;
+        c11_vector__push(PyObject*, &self->frozen_roots, obj);
+    }
+}
+
+static void ManagedHeap__adjust_threshold(ManagedHeap* self, int freed) {
     // adjust `gc_threshold` based on `freed_ma`
     self->freed_ma[0] = self->freed_ma[1];
     self->freed_ma[1] = self->freed_ma[2];
@@ -42,6 +84,10 @@ void ManagedHeap__collect_if_needed(ManagedHeap* self) {
     int avg_freed = (self->freed_ma[0] + self->freed_ma[1] + self->freed_ma[2]) / 3;
     const int upper = PK_GC_MIN_THRESHOLD * 16;
     const int lower = PK_GC_MIN_THRESHOLD / 2;
+    if(avg_freed == 0) {
+        self->gc_threshold = upper;
+        return;
+    }
     float free_ratio = (float)avg_freed / self->gc_threshold;
     int new_threshold = self->gc_threshold * (1.5f / free_ratio);
     // printf("gc_threshold=%d, avg_freed=%d, new_threshold=%d\n", self->gc_threshold, avg_freed,
@@ -49,23 +95,294 @@ void ManagedHeap__collect_if_needed(ManagedHeap* self) {
     self->gc_threshold = c11__min(c11__max(new_threshold, lower), upper);
 }
 
-int ManagedHeap__collect(ManagedHeap* self) {
+static bool ManagedHeap__full_collection_due(ManagedHeap* self) {
+#if PK_ENABLE_GENERATIONAL_GC
+    // a full collection is due once the old generation has doubled
+    return self->promoted > c11__max(self->survived, PK_GC_MIN_THRESHOLD);
+#else
+    return true;
+#endif
+}
+
+static GCStats* ManagedHeap__stats(ManagedHeap* self) {
+    return &self->gc_stats[self->gc_stats_count % kGCStatsLength];
+}
+
+static void ManagedHeap__begin_stats(ManagedHeap* self, int generation, bool incremental) {
+    GCStats* stats = ManagedHeap__stats(self);
+    memset(stats, 0, sizeof(GCStats));
+    stats->start_ns = time_ns();
+    stats->generation = generation;
+    stats->incremental = incremental;
+    ManagedHeap__fire_callbacks(self, "start", stats);
+}
+
+// the collection has freed `freed` objects, update the threshold if it was automatic
+static void ManagedHeap__end_stats(ManagedHeap* self, int freed, bool adjust) {
+    if(adjust) ManagedHeap__adjust_threshold(self, freed);
+    GCStats* stats = ManagedHeap__stats(self);
+    stats->threshold = self->gc_threshold;
+    self->gc_stats_count++;
+    ManagedHeap__fire_callbacks(self, "stop", stats);
+}
+
+static void ManagedHeap__begin_mark(ManagedHeap* self) {
+    self->gc_marked = 0;
+    ManagedHeap__mark_roots(self);
+    self->gc_phase = GCPhase_MARK;
+}
+
+static void ManagedHeap__finish_sweep(ManagedHeap* self) {
+    int budget = INT32_MAX;
+    MultiPool__sweep_step(&self->small_objects, &budget);
+}
+
+#if PK_ENABLE_GENERATIONAL_GC
+// forget the generations and mark everything again
+static void ManagedHeap__unmark(ManagedHeap* self) {
+    ManagedHeap__finish_sweep(self);
+    MultiPool__unmark(&self->small_objects);
+    c11__foreach(PyObject*, &self->large_objects, p) (*p)->gc_marked = (*p)->gc_frozen;
+    c11__foreach(PyObject*, &self->remembered, p) (*p)->gc_remembered = false;
+    c11_vector__clear(&self->remembered);
+}
+#endif
+
+static void ManagedHeap__begin(ManagedHeap* self) {
+    assert(self->gc_phase == GCPhase_IDLE);
+    ManagedHeap__begin_stats(self, 1, true);
+    int64_t start = time_ns();
     self->gc_counter = 0;
-    ManagedHeap__mark(self);
-    int freed = ManagedHeap__sweep(self);
-    // printf("GC: collected %d objects\n", freed);
+#if PK_ENABLE_GENERATIONAL_GC
+    ManagedHeap__unmark(self);
+#endif
+    ManagedHeap__begin_mark(self);
+    ManagedHeap__stats(self)->mark_ns += time_ns() - start;
+}
+
+// do about `work` units of the incremental collection
+// returns the number of freed objects if the collection is finished, otherwise -1
+static int ManagedHeap__advance(ManagedHeap* self, int work) {
+    GCStats* stats = ManagedHeap__stats(self);
+    int64_t start = time_ns();
+    int freed = -1;
+    switch(self->gc_phase) {
+        case GCPhase_IDLE: return 0;
+        case GCPhase_MARK: {
+            // objects written since they were visited are gray again
+            ManagedHeap__mark_remembered(self);
+            self->gc_marked += ManagedHeap__mark_gray(self, work);
+            if(self->gc_roots.length > 0) break;
+            // the roots are not guarded by write barriers, finish marking atomically
+            ManagedHeap__mark_roots(self);
+            self->gc_marked += ManagedHeap__mark_gray(self, -1);
+            stats->marked = self->gc_marked;
+            int64_t now = time_ns();
+            stats->mark_ns += now - start;
+            start = now;
+            // large objects are swept at once, small objects arena by arena
+            self->gc_phase = GCPhase_SWEEP;
+            stats->freed_large = ManagedHeap__sweep_large(self, false);
+            self->gc_freed = stats->freed_large;
+            self->gc_freed +=
+                MultiPool__begin_sweep(&self->small_objects, false, stats->freed_small);
+            break;
+        }
+        case GCPhase_SWEEP: {
+            if(!MultiPool__sweep_step(&self->small_objects, &work)) break;
+            freed = self->gc_freed;
+            self->gc_phase = GCPhase_IDLE;
+#if PK_ENABLE_GENERATIONAL_GC
+            self->survived = self->gc_marked;
+            self->promoted = 0;
+#else
+            // marks are cleared by sweeping, forget the objects written meanwhile
+            c11__foreach(PyObject*, &self->remembered, p) (*p)->gc_remembered = false;
+            c11_vector__clear(&self->remembered);
+#endif
+            break;
+        }
+    }
+    ManagedHeap__remember_temporaries(self);
+    if(self->gc_phase == GCPhase_MARK) {
+        stats->mark_ns += time_ns() - start;
+    } else {
+        stats->sweep_ns += time_ns() - start;
+    }
+    if(freed >= 0) ManagedHeap__end_stats(self, freed, true);
     return freed;
 }
 
-int ManagedHeap__sweep(ManagedHeap* self) {
-    // small_objects
-    int small_freed = MultiPool__sweep_dealloc(&self->small_objects);
-    // large_objects
+static int ManagedHeap__finish(ManagedHeap* self) {
+    int freed;
+    do {
+        freed = ManagedHeap__advance(self, INT32_MAX);
+    } while(freed < 0);
+    return freed;
+}
+
+// the result includes a finished incremental cycle, which has its own stats entry
+static int ManagedHeap__full_collection(ManagedHeap* self, bool adjust) {
+    int freed = 0;
+    if(self->gc_phase != GCPhase_IDLE) freed = ManagedHeap__finish(self);
+    ManagedHeap__begin_stats(self, 1, false);
+    GCStats* stats = ManagedHeap__stats(self);
+    int64_t start = time_ns();
+    self->gc_counter = 0;
+#if PK_ENABLE_GENERATIONAL_GC
+    ManagedHeap__unmark(self);
+    stats->marked = ManagedHeap__mark(self, true);
+    self->survived = stats->marked;
+    self->promoted = 0;
+#else
+    stats->marked = ManagedHeap__mark(self, true);
+#endif
+    int64_t mark_end = time_ns();
+    int swept = ManagedHeap__sweep(self, false);
+#if PK_ENABLE_GENERATIONAL_GC
+    ManagedHeap__remember_temporaries(self);
+#endif
+    stats->mark_ns = mark_end - start;
+    stats->sweep_ns = time_ns() - mark_end;
+    ManagedHeap__end_stats(self, swept, adjust);
+    // printf("GC: collected %d objects\n", freed + swept);
+    return freed + swept;
+}
+
+static int ManagedHeap__young_collection(ManagedHeap* self, bool adjust) {
+#if PK_ENABLE_GENERATIONAL_GC
+    if(self->gc_phase != GCPhase_IDLE) return ManagedHeap__finish(self);
+    ManagedHeap__begin_stats(self, 0, false);
+    GCStats* stats = ManagedHeap__stats(self);
+    int64_t start = time_ns();
+    self->gc_counter = 0;
+    // old objects are already marked, so only young objects are visited
+    stats->marked = ManagedHeap__mark(self, false);
+    self->promoted += stats->marked;
+    int64_t mark_end = time_ns();
+    int freed = ManagedHeap__sweep(self, true);
+    ManagedHeap__remember_temporaries(self);
+    stats->mark_ns = mark_end - start;
+    stats->sweep_ns = time_ns() - mark_end;
+    ManagedHeap__end_stats(self, freed, adjust);
+    return freed;
+#else
+    return ManagedHeap__full_collection(self, adjust);
+#endif
+}
+
+void ManagedHeap__collect_if_needed(ManagedHeap* self) {
+    if(!self->gc_enabled || self->gc_in_callbacks) return;
+    if(self->gc_phase != GCPhase_IDLE) {
+        // pace the incremental collection with allocations
+        if(self->gc_counter < kGCStepInterval) return;
+        int work = self->gc_counter * kGCStepMul;
+        self->gc_counter = 0;
+        ManagedHeap__advance(self, work);
+        return;
+    }
+    if(self->gc_counter < self->gc_threshold) return;
+    if(!ManagedHeap__full_collection_due(self)) {
+        ManagedHeap__young_collection(self, true);
+        return;
+    }
+#if PK_ENABLE_INCREMENTAL_GC
+    ManagedHeap__begin(self);
+    ManagedHeap__advance(self, kGCStepInterval * kGCStepMul);
+#else
+    ManagedHeap__full_collection(self, true);
+#endif
+}
+
+bool ManagedHeap__step(ManagedHeap* self, int budget_us) {
+    // callbacks only run between two collections
+    if(self->gc_in_callbacks) return true;
+    if(self->gc_phase == GCPhase_IDLE) {
+#if PK_ENABLE_GENERATIONAL_GC
+        if(!ManagedHeap__full_collection_due(self)) {
+            if(self->gc_counter > 0) ManagedHeap__young_collection(self, true);
+            return true;
+        }
+#else
+        // nothing allocated since the last collection
+        if(self->gc_counter == 0) return true;
+#endif
+        ManagedHeap__begin(self);
+    }
+    int64_t deadline = time_ns() + (int64_t)budget_us * 1000;
+    do {
+        if(ManagedHeap__advance(self, kGCStepWork) >= 0) return true;
+    } while(time_ns() < deadline);
+    return false;
+}
+
+int ManagedHeap__collect(ManagedHeap* self) {
+    if(self->gc_in_callbacks) return 0;
+    return ManagedHeap__full_collection(self, false);
+}
+
+void ManagedHeap__freeze(ManagedHeap* self) {
+    if(self->gc_in_callbacks) return;
+    // collect first, so that only live objects are frozen
+    ManagedHeap__collect(self);
+    self->frozen_count += MultiPool__freeze(&self->small_objects);
+    c11__foreach(PyObject*, &self->large_objects, p) {
+        if((*p)->gc_frozen) continue;
+        (*p)->gc_frozen = true;
+        (*p)->gc_marked = true;
+        self->frozen_count++;
+    }
+    // objects remembered as temporaries may still be filled in by native code
+    c11__foreach(PyObject*, &self->remembered, p) {
+        if((*p)->gc_frozen_root) continue;
+        (*p)->gc_frozen_root = true;
+        c11_vector__push(PyObject*, &self->frozen_roots, *p);
+    }
+#if PK_ENABLE_GENERATIONAL_GC
+    self->survived = 0;
+#endif
+}
+
+void ManagedHeap__unfreeze(ManagedHeap* self) {
+    if(self->gc_phase != GCPhase_IDLE) ManagedHeap__finish(self);
+    ManagedHeap__finish_sweep(self);
+    MultiPool__unfreeze(&self->small_objects);
+    c11__foreach(PyObject*, &self->large_objects, p) {
+        if(!(*p)->gc_frozen) continue;
+        (*p)->gc_frozen = false;
+#if !PK_ENABLE_GENERATIONAL_GC
+        (*p)->gc_marked = false;
+#endif
+    }
+    c11__foreach(PyObject*, &self->frozen_roots, p) (*p)->gc_frozen_root = false;
+    c11_vector__clear(&self->frozen_roots);
+#if PK_ENABLE_GENERATIONAL_GC
+    // they are old objects now
+    self->survived += self->frozen_count;
+#endif
+    self->frozen_count = 0;
+}
+
+int ManagedHeap__collect_young(ManagedHeap* self) {
+    if(self->gc_in_callbacks) return 0;
+    return ManagedHeap__young_collection(self, false);
+}
+
+static int ManagedHeap__sweep_large(ManagedHeap* self, bool young_only) {
     int large_living_count = 0;
-    for(int i = 0; i < self->large_objects.length; i++) {
+    int start = 0;
+#if PK_ENABLE_GENERATIONAL_GC
+    if(young_only) {
+        large_living_count = self->large_old_length;
+        start = self->large_old_length;
+    }
+#endif
+    for(int i = start; i < self->large_objects.length; i++) {
         PyObject* obj = c11__getitem(PyObject*, &self->large_objects, i);
         if(obj->gc_marked) {
-            obj->gc_marked = false;
+#if !PK_ENABLE_GENERATIONAL_GC
+            obj->gc_marked = obj->gc_frozen;
+#endif
             c11__setitem(PyObject*, &self->large_objects, large_living_count, obj);
             large_living_count++;
         } else {
@@ -76,9 +393,22 @@ int ManagedHeap__sweep(ManagedHeap* self) {
     // shrink `self->large_objects`
     int large_freed = self->large_objects.length - large_living_count;
     self->large_objects.length = large_living_count;
+#if PK_ENABLE_GENERATIONAL_GC
+    self->large_old_length = large_living_count;
+#endif
     // printf("large_freed=%d\n", large_freed);
+    return large_freed;
+}
+
+int ManagedHeap__sweep(ManagedHeap* self, bool young_only) {
+    GCStats* stats = ManagedHeap__stats(self);
+    // young arenas are swept lazily, right before allocating from them
+    int small_freed =
+        MultiPool__begin_sweep(&self->small_objects, young_only, stats->freed_small);
+    if(!young_only) ManagedHeap__finish_sweep(self);
     // printf("small_freed=%d\n", small_freed);
-    return small_freed + large_freed;
+    stats->freed_large = ManagedHeap__sweep_large(self, young_only);
+    return small_freed + stats->freed_large;
 }
 
 PyObject* ManagedHeap__gcnew(ManagedHeap* self, py_Type type, int slots, int udsize) {
@@ -95,7 +425,17 @@ PyObject* ManagedHeap__gcnew(ManagedHeap* self, py_Type type, int slots, int uds
     }
     obj->type = type;
     obj->gc_marked = false;
+    obj->gc_large = size > kPoolMaxBlockSize;
+    obj->gc_remembered = false;
+    obj->gc_frozen = false;
+    obj->gc_frozen_root = false;
+    assert(!PyObject__is_marked(obj));
     obj->slots = slots;
+#if PK_ENABLE_HEAP_PROFILER
+    VM* vm = pk_current_vm;
+    obj->alloc_site = HeapProfiler__record(&vm->heap_profiler, type, vm->top_frame);
+    obj->alloc_size = obj->gc_large ? size : PoolArena__of(obj)->block_size;
+#endif
 
     // initialize slots or dict
     if(slots >= 0) {
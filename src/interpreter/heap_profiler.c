@@ -0,0 +1,102 @@
+#include "pocketpy/interpreter/heap_profiler.h"
+#include "pocketpy/objects/codeobject.h"
+#include "pocketpy/objects/object.h"
+#include "pocketpy/objects/sourcedata.h"
+#include "pocketpy/pocketpy.h"
+#include <assert.h>
+#include <string.h>
+
+#if PK_ENABLE_HEAP_PROFILER
+
+void HeapProfiler__ctor(HeapProfiler* self) {
+    c11_smallmap_p2i__ctor(&self->lines);
+    c11_vector__ctor(&self->sites, sizeof(HeapSite));
+    c11_vector__ctor(&self->allocated, sizeof(py_i64));
+    HeapSite native = {.src = NULL, .lineno = 0, .allocated = 0};
+    c11_vector__push(HeapSite, &self->sites, native);
+    self->last_src = NULL;
+    self->last_lines = NULL;
+}
+
+void HeapProfiler__dtor(HeapProfiler* self) {
+    for(int i = 0; i < self->lines.length; i++) {
+        c11_smallmap_p2i_KV kv = c11__getitem(c11_smallmap_p2i_KV, &self->lines, i);
+        SourceData_ src = (SourceData_)kv.key;
+        PK_DECREF(src);
+        PK_FREE((void*)kv.value);
+    }
+    c11_smallmap_p2i__dtor(&self->lines);
+    c11_vector__dtor(&self->sites);
+    c11_vector__dtor(&self->allocated);
+}
+
+static int HeapProfiler__site(HeapProfiler* self, SourceLocation loc) {
+    int max_lineno = loc.src->line_starts.length;
+    if(loc.lineno < 0 || loc.lineno > max_lineno) return 0;
+    if(loc.src != self->last_src) {
+        int* lines = (int*)c11_smallmap_p2i__get(&self->lines, loc.src, 0);
+        if(lines == NULL) {
+            // 0 is never a python site, it means the line is not seen yet
+            lines = PK_MALLOC(sizeof(int) * (max_lineno + 1));
+            memset(lines, 0, sizeof(int) * (max_lineno + 1));
+            c11_smallmap_p2i__set(&self->lines, loc.src, (py_i64)lines);
+            // keep the source alive, so that its address is not reused by another one
+            PK_INCREF(loc.src);
+        }
+        self->last_src = loc.src;
+        self->last_lines = lines;
+    }
+    int* index = &self->last_lines[loc.lineno];
+    if(*index == 0) {
+        *index = self->sites.length;
+        HeapSite site = {.src = loc.src, .lineno = loc.lineno, .allocated = 0};
+        c11_vector__push(HeapSite, &self->sites, site);
+    }
+    return *index;
+}
+
+int HeapProfiler__record(HeapProfiler* self, py_Type type, py_Frame* frame) {
+    while(self->allocated.length <= type) {
+        c11_vector__push(py_i64, &self->allocated, 0);
+    }
+    c11__getitem(py_i64, &self->allocated, type)++;
+    int index = frame ? HeapProfiler__site(self, Frame__source_location(frame)) : 0;
+    c11__at(HeapSite, &self->sites, index)->allocated++;
+    return index;
+}
+
+typedef struct HeapCensusContext {
+    c11_vector* types;
+    c11_vector* sites;
+} HeapCensusContext;
+
+static void HeapProfiler__count(void* obj_, void* ctx_) {
+    PyObject* obj = obj_;
+    HeapCensusContext* ctx = ctx_;
+    HeapCensusRow* type_row = c11__at(HeapCensusRow, ctx->types, obj->type);
+    HeapCensusRow* site_row = c11__at(HeapCensusRow, ctx->sites, obj->alloc_site);
+    type_row->count++;
+    type_row->bytes += obj->alloc_size;
+    site_row->count++;
+    site_row->bytes += obj->alloc_size;
+}
+
+void HeapProfiler__census(HeapProfiler* self,
+                          ManagedHeap* heap,
+                          c11_vector* types,
+                          c11_vector* sites) {
+    HeapCensusRow zero = {0, 0};
+    c11_vector__clear(types);
+    c11_vector__clear(sites);
+    for(int i = 0; i < self->allocated.length; i++) {
+        c11_vector__push(HeapCensusRow, types, zero);
+    }
+    for(int i = 0; i < self->sites.length; i++) {
+        c11_vector__push(HeapCensusRow, sites, zero);
+    }
+    HeapCensusContext ctx = {types, sites};
+    MultiPool__visit(&heap->small_objects, HeapProfiler__count, &ctx);
+    c11__foreach(PyObject*, &heap->large_objects, p) HeapProfiler__count(*p, &ctx);
+}
+
+#endif
@@ -41,9 +41,10 @@ void UsedBlockList__insert(UsedBlockList *self, PoolBlockIndex data) {
 
 static PoolArena* PoolArena__new(int block_size) {
     assert(kPoolArenaSize % block_size == 0);
+    assert(sizeof(PoolArena) <= kPoolArenaAlign);
     int block_count = kPoolArenaSize / block_size;
     assert(block_count < (PoolBlockIndex)-1);
-    PoolArena* self = PK_MALLOC(sizeof(PoolArena));
+    PoolArena* self = PK_ALIGNED_MALLOC(kPoolArenaAlign, kPoolArenaAlign);
     self->block_size = block_size;
     self->block_count = block_count;
     self->unused_length = block_count;
@@ -52,68 +53,121 @@ static PoolArena* PoolArena__new(int block_size) {
         self->unused[i] = i;
     }
     UsedBlockList__ctor(&self->used_blocks, block_count);
-    memset(self->data, 0, kPoolArenaSize);
+    self->dirty = false;
+    memset(self->allocated, 0, sizeof(self->allocated));
+    memset(self->marks, 0, sizeof(self->marks));
+    memset(self->frozen, 0, sizeof(self->frozen));
     return self;
 }
 
 static void PoolArena__delete(PoolArena* self) {
     for(int i = 0; i < self->block_count; i++) {
-        PyObject* obj = (PyObject*)(self->data + i * self->block_size);
-        if(obj->type != 0) PyObject__dtor(obj);
+        int granule = (i * self->block_size) >> kPoolGranuleShift;
+        if(!PoolArena__bitmap_get(self->allocated, granule)) continue;
+        PyObject__dtor((PyObject*)(self->data + i * self->block_size));
     }
     PK_FREE(self->unused);
     UsedBlockList__dtor(&self->used_blocks);
-    PK_FREE(self);
+    PK_ALIGNED_FREE(self);
 }
 
 static void* PoolArena__alloc(PoolArena* self) {
     assert(self->unused_length > 0);
     PoolBlockIndex index = self->unused[self->unused_length - 1];
     self->unused_length--;
+    int granule = (index * self->block_size) >> kPoolGranuleShift;
+    PoolArena__bitmap_set(self->allocated, granule);
     return self->data + index * self->block_size;
 }
 
+static int PoolArena__popcount(uint64_t bits) {
+    int count = 0;
+    while(bits) {
+        bits &= bits - 1;
+        count++;
+    }
+    return count;
+}
+
+static int PoolArena__count_unmarked(PoolArena* self) {
+    int count = 0;
+    for(int i = 0; i < kPoolBitmapLength; i++) {
+        count += PoolArena__popcount(self->allocated[i] & ~self->marks[i]);
+    }
+    return count;
+}
+
+static void PoolArena__unmark(PoolArena* self) {
+    memcpy(self->marks, self->frozen, sizeof(self->marks));
+}
+
 static int PoolArena__sweep_dealloc(PoolArena* self) {
     int freed = 0;
+    self->dirty = false;
+    if(PoolArena__count_unmarked(self) == 0) {
+        // nothing to free, `unused` is still valid
+#if !PK_ENABLE_GENERATIONAL_GC
+        PoolArena__unmark(self);
+#endif
+        return 0;
+    }
     self->unused_length = 0;
     for(PoolBlockIndex i = 0; i < self->block_count; i++) {
-        PyObject* obj = (PyObject*)(self->data + i * self->block_size);
-        if(obj->type == 0) {
-            // free slot
-            self->unused[self->unused_length] = i;
-            self->unused_length++;
-        } else {
-            if(!obj->gc_marked) {
-                // not marked, need to free
-                PyObject__dtor(obj);
-                obj->type = 0;
-                freed++;
-                self->unused[self->unused_length] = i;
-                self->unused_length++;
-            } else {
-                // marked, clear mark
-                obj->gc_marked = false;
-            }
+        int granule = (i * self->block_size) >> kPoolGranuleShift;
+        if(PoolArena__bitmap_get(self->allocated, granule)) {
+            // a marked object is alive, an old object if the mark is kept
+            if(PoolArena__bitmap_get(self->marks, granule)) continue;
+            // not marked, need to free
+            PyObject__dtor((PyObject*)(self->data + i * self->block_size));
+            PoolArena__bitmap_reset(self->allocated, granule);
+            freed++;
         }
+        self->unused[self->unused_length] = i;
+        self->unused_length++;
     }
+#if !PK_ENABLE_GENERATIONAL_GC
+    PoolArena__unmark(self);
+#endif
     return freed;
 }
 
 static void Pool__ctor(Pool* self, int block_size) {
     c11_vector__ctor(&self->arenas, sizeof(PoolArena*));
     c11_vector__ctor(&self->no_free_arenas, sizeof(PoolArena*));
+    c11_vector__ctor(&self->unswept_arenas, sizeof(PoolArena*));
     self->block_size = block_size;
 }
 
 static void Pool__dtor(Pool* self) {
     c11__foreach(PoolArena*, &self->arenas, arena) PoolArena__delete(*arena);
     c11__foreach(PoolArena*, &self->no_free_arenas, arena) PoolArena__delete(*arena);
+    c11__foreach(PoolArena*, &self->unswept_arenas, arena) PoolArena__delete(*arena);
     c11_vector__dtor(&self->arenas);
     c11_vector__dtor(&self->no_free_arenas);
+    c11_vector__dtor(&self->unswept_arenas);
+}
+
+static void Pool__sweep_one(Pool* self) {
+    PoolArena* item = c11_vector__back(PoolArena*, &self->unswept_arenas);
+    c11_vector__pop(&self->unswept_arenas);
+    // an empty arena is released once it stays unused between two sweeps
+    bool idle = !item->dirty;
+    PoolArena__sweep_dealloc(item);
+    if(item->unused_length == 0) {
+        c11_vector__push(PoolArena*, &self->no_free_arenas, item);
+    } else if(item->unused_length == item->block_count && idle) {
+        PoolArena__delete(item);
+    } else {
+        c11_vector__push(PoolArena*, &self->arenas, item);
+    }
 }
 
 static void* Pool__alloc(Pool* self) {
     PoolArena* arena;
+    // sweep unswept arenas lazily, right before allocating from them
+    while(self->arenas.length == 0 && self->unswept_arenas.length > 0) {
+        Pool__sweep_one(self);
+    }
     if(self->arenas.length == 0) {
         arena = PoolArena__new(self->block_size);
         c11_vector__push(PoolArena*, &self->arenas, arena);
@@ -121,6 +175,7 @@ static void* Pool__alloc(Pool* self) {
         arena = c11_vector__back(PoolArena*, &self->arenas);
     }
     void* ptr = PoolArena__alloc(arena);
+    arena->dirty = true;
     if(arena->unused_length == 0) {
         c11_vector__pop(&self->arenas);
         c11_vector__push(PoolArena*, &self->no_free_arenas, arena);
@@ -128,80 +183,150 @@ static void* Pool__alloc(Pool* self) {
     return ptr;
 }
 
-static int Pool__sweep_dealloc(Pool* self, c11_vector* arenas, c11_vector* no_free_arenas) {
+static int Pool__begin_sweep(Pool* self, c11_vector* arenas, bool young_only) {
+    int unmarked = 0;
     c11_vector__clear(arenas);
-    c11_vector__clear(no_free_arenas);
-
-    int freed = 0;
-    for(int i = 0; i < self->arenas.length; i++) {
-        PoolArena* item = c11__getitem(PoolArena*, &self->arenas, i);
-        assert(item->unused_length > 0);
-        freed += PoolArena__sweep_dealloc(item);
-        if(item->unused_length == item->block_count) {
-            // all free
-            if(arenas->length > 0) {
-                // at least one arena
-                PoolArena__delete(item);
-            } else {
-                // no arena
-                c11_vector__push(PoolArena*, arenas, item);
-            }
-        } else {
-            // some free
-            c11_vector__push(PoolArena*, arenas, item);
+    c11__foreach(PoolArena*, &self->arenas, p) {
+        // only old objects in a clean arena
+        if(young_only && !(*p)->dirty) {
+            c11_vector__push(PoolArena*, arenas, *p);
+            continue;
         }
+        unmarked += PoolArena__count_unmarked(*p);
+        c11_vector__push(PoolArena*, &self->unswept_arenas, *p);
     }
-    for(int i = 0; i < self->no_free_arenas.length; i++) {
-        PoolArena* item = c11__getitem(PoolArena*, &self->no_free_arenas, i);
-        freed += PoolArena__sweep_dealloc(item);
-        if(item->unused_length == 0) {
-            // still no free
-            c11_vector__push(PoolArena*, no_free_arenas, item);
-        } else {
-            if(item->unused_length == item->block_count) {
-                // all free
-                PoolArena__delete(item);
-            } else {
-                // some free
-                c11_vector__push(PoolArena*, arenas, item);
-            }
+    c11_vector__swap(&self->arenas, arenas);
+    c11_vector__clear(arenas);
+    c11__foreach(PoolArena*, &self->no_free_arenas, p) {
+        if(young_only && !(*p)->dirty) {
+            c11_vector__push(PoolArena*, arenas, *p);
+            continue;
         }
+        unmarked += PoolArena__count_unmarked(*p);
+        c11_vector__push(PoolArena*, &self->unswept_arenas, *p);
     }
-
-    c11_vector__swap(&self->arenas, arenas);
-    c11_vector__swap(&self->no_free_arenas, no_free_arenas);
-    return freed;
+    c11_vector__swap(&self->no_free_arenas, arenas);
+    return unmarked;
 }
 
 void* MultiPool__alloc(MultiPool* self, int size) {
-    if(size == 0) return NULL;
-    int index = (size - 1) >> 5;
-    if(index < kMultiPoolCount) {
-        Pool* pool = &self->pools[index];
-        return Pool__alloc(pool);
-    }
-    return NULL;
+    if(size == 0 || size > kPoolMaxBlockSize) return NULL;
+    int index = self->size_classes[(size - 1) >> kPoolGranuleShift];
+    return Pool__alloc(&self->pools[index]);
 }
 
-int MultiPool__sweep_dealloc(MultiPool* self) {
+int MultiPool__begin_sweep(MultiPool* self, bool young_only, int freed[kMultiPoolCount]) {
     c11_vector arenas;
-    c11_vector no_free_arenas;
     c11_vector__ctor(&arenas, sizeof(PoolArena*));
-    c11_vector__ctor(&no_free_arenas, sizeof(PoolArena*));
-    int freed = 0;
+    int unmarked = 0;
     for(int i = 0; i < kMultiPoolCount; i++) {
         Pool* item = &self->pools[i];
-        freed += Pool__sweep_dealloc(item, &arenas, &no_free_arenas);
+        // unswept arenas are clean, their unmarked objects were counted before
+        assert(young_only || item->unswept_arenas.length == 0);
+        int count = Pool__begin_sweep(item, &arenas, young_only);
+        freed[i] += count;
+        unmarked += count;
     }
     c11_vector__dtor(&arenas);
-    c11_vector__dtor(&no_free_arenas);
-    return freed;
+    return unmarked;
 }
 
+bool MultiPool__sweep_step(MultiPool* self, int* budget) {
+    for(int i = 0; i < kMultiPoolCount; i++) {
+        Pool* item = &self->pools[i];
+        while(item->unswept_arenas.length > 0) {
+            if(*budget <= 0) return false;
+            *budget -= c11_vector__back(PoolArena*, &item->unswept_arenas)->block_count;
+            Pool__sweep_one(item);
+        }
+    }
+    return true;
+}
+
+void MultiPool__unmark(MultiPool* self) {
+    for(int i = 0; i < kMultiPoolCount; i++) {
+        Pool* item = &self->pools[i];
+        assert(item->unswept_arenas.length == 0);
+        c11__foreach(PoolArena*, &item->arenas, arena) PoolArena__unmark(*arena);
+        c11__foreach(PoolArena*, &item->no_free_arenas, arena) PoolArena__unmark(*arena);
+    }
+}
+
+int MultiPool__freeze(MultiPool* self) {
+    int frozen = 0;
+    for(int i = 0; i < kMultiPoolCount; i++) {
+        Pool* item = &self->pools[i];
+        assert(item->unswept_arenas.length == 0);
+        for(int j = 0; j < 2; j++) {
+            c11_vector* arenas = j == 0 ? &item->arenas : &item->no_free_arenas;
+            c11__foreach(PoolArena*, arenas, p) {
+                PoolArena* arena = *p;
+                for(int k = 0; k < kPoolBitmapLength; k++) {
+                    frozen += PoolArena__popcount(arena->allocated[k] & ~arena->frozen[k]);
+                    arena->frozen[k] |= arena->allocated[k];
+                    arena->marks[k] |= arena->allocated[k];
+                }
+            }
+        }
+    }
+    return frozen;
+}
+
+void MultiPool__unfreeze(MultiPool* self) {
+    for(int i = 0; i < kMultiPoolCount; i++) {
+        Pool* item = &self->pools[i];
+        assert(item->unswept_arenas.length == 0);
+        for(int j = 0; j < 2; j++) {
+            c11_vector* arenas = j == 0 ? &item->arenas : &item->no_free_arenas;
+            c11__foreach(PoolArena*, arenas, p) {
+                PoolArena* arena = *p;
+#if !PK_ENABLE_GENERATIONAL_GC
+                // marks are only kept during a collection
+                for(int k = 0; k < kPoolBitmapLength; k++) {
+                    arena->marks[k] &= ~arena->frozen[k];
+                }
+#endif
+                memset(arena->frozen, 0, sizeof(arena->frozen));
+            }
+        }
+    }
+}
+
+void MultiPool__visit(MultiPool* self, void (*f)(void* obj, void* ctx), void* ctx) {
+    for(int i = 0; i < kMultiPoolCount; i++) {
+        Pool* item = &self->pools[i];
+        assert(item->unswept_arenas.length == 0);
+        for(int j = 0; j < 2; j++) {
+            c11_vector* arenas = j == 0 ? &item->arenas : &item->no_free_arenas;
+            c11__foreach(PoolArena*, arenas, p) {
+                PoolArena* arena = *p;
+                for(int k = 0; k < arena->block_count; k++) {
+                    int granule = (k * arena->block_size) >> kPoolGranuleShift;
+                    if(!PoolArena__bitmap_get(arena->allocated, granule)) continue;
+                    f(arena->data + k * arena->block_size, ctx);
+                }
+            }
+        }
+    }
+}
+
+// every block size divides `kPoolArenaSize`, so 224 is skipped and 192 bytes are followed by 256
+static const int kPoolBlockSizes[kMultiPoolCount] = {
+    32, 64, 96, 128, 160, 192, 256, 320, 384, 512,
+    640, 768, 1024, 1280, 1536, 2048, 2560, 3072, 4096,
+};
+
 void MultiPool__ctor(MultiPool* self) {
+    int index = 0;
     for(int i = 0; i < kMultiPoolCount; i++) {
-        Pool__ctor(&self->pools[i], 32 * (i + 1));
+        int block_size = kPoolBlockSizes[i];
+        Pool__ctor(&self->pools[i], block_size);
+        // the smallest pool whose blocks fit
+        for(; index < (block_size >> kPoolGranuleShift); index++) {
+            self->size_classes[index] = i;
+        }
     }
+    assert(index == c11__count_array(self->size_classes));
 }
 
 void MultiPool__dtor(MultiPool* self) {
@@ -215,14 +340,17 @@ c11_string* MultiPool__summary(MultiPool* self) {
     c11_sbuf__ctor(&sbuf);
     for(int i = 0; i < kMultiPoolCount; i++) {
         Pool* item = &self->pools[i];
-        int total_bytes = (item->arenas.length + item->no_free_arenas.length) * kPoolArenaSize;
+        int total_bytes =
+            (item->arenas.length + item->no_free_arenas.length + item->unswept_arenas.length) *
+            kPoolArenaSize;
         int used_bytes = 0;
         for(int j = 0; j < item->arenas.length; j++) {
             PoolArena* arena = c11__getitem(PoolArena*, &item->arenas, j);
             used_bytes += (arena->block_count - arena->unused_length) * arena->block_size;
         }
         used_bytes += item->no_free_arenas.length * kPoolArenaSize;
-        float used_pct = (float)used_bytes / total_bytes * 100;
+        // most size classes have no arena yet
+        float used_pct = total_bytes > 0 ? (float)used_bytes / total_bytes * 100 : 0.0f;
         char buf[256];
         snprintf(buf,
                  sizeof(buf),
@@ -1,5 +1,6 @@
 #include "pocketpy/interpreter/vm.h"
 #include <assert.h>
+#include <string.h>
 
 py_ItemRef pk_tpfindname(py_TypeInfo* ti, py_Name name) {
     assert(ti != NULL);
@@ -11,6 +12,96 @@ py_ItemRef pk_tpfindname(py_TypeInfo* ti, py_Name name) {
     return NULL;
 }
 
+#define MAGIC_SLOT_TABLE_SIZE 128
+
+static struct {
+    py_Name key;
+    int slot;
+} pk_magicslot_table[MAGIC_SLOT_TABLE_SIZE];
+
+static py_Name* const pk_magicslot_names[MagicSlot__COUNT] = {
+#define MAGIC_METHOD(x) &x,
+#include "pocketpy/xmacros/magics.h"
+#undef MAGIC_METHOD
+};
+
+static_assert(MagicSlot__COUNT <= 64, "magics_resolved cannot hold all magic slots");
+
+void pk_magicslots_initialize() {
+    memset(pk_magicslot_table, 0, sizeof(pk_magicslot_table));
+    for(int slot = 0; slot < MagicSlot__COUNT; slot++) {
+        py_Name name = *pk_magicslot_names[slot];
+        uintptr_t i = ThomasWangInt32Hash(name) & (MAGIC_SLOT_TABLE_SIZE - 1);
+        while(pk_magicslot_table[i].key != NULL) {
+            i = (i + 1) & (MAGIC_SLOT_TABLE_SIZE - 1);
+        }
+        pk_magicslot_table[i].key = name;
+        pk_magicslot_table[i].slot = slot;
+    }
+}
+
+int pk_magicslot(py_Name name) {
+    uintptr_t i = ThomasWangInt32Hash(name) & (MAGIC_SLOT_TABLE_SIZE - 1);
+    while(pk_magicslot_table[i].key != NULL) {
+        if(pk_magicslot_table[i].key == name) return pk_magicslot_table[i].slot;
+        i = (i + 1) & (MAGIC_SLOT_TABLE_SIZE - 1);
+    }
+    return -1;
+}
+
+py_ItemRef pk_tpfindmagicslot(py_TypeInfo* ti, MagicSlot slot) {
+    uint32_t version = pk_tpversion(ti);
+    // no version available, resolve it the slow way
+    if(version == 0) return pk_tpfindname(ti, *pk_magicslot_names[slot]);
+    if(ti->magics_version != version) {
+        ti->magics_version = version;
+        ti->magics_resolved = 0;
+    }
+    uint64_t bit = (uint64_t)1 << slot;
+    if(!(ti->magics_resolved & bit)) {
+        ti->magics[slot] = pk_tpfindname(ti, *pk_magicslot_names[slot]);
+        ti->magics_resolved |= bit;
+    }
+    return ti->magics[slot];
+}
+
+py_ItemRef pk_tpfindmagic(py_TypeInfo* ti, py_Name name) {
+    int slot = pk_magicslot(name);
+    if(slot < 0) return pk_tpfindname(ti, name);
+    return pk_tpfindmagicslot(ti, slot);
+}
+
+#undef MAGIC_SLOT_TABLE_SIZE
+
+uint32_t pk_tpversion(py_TypeInfo* ti) {
+    if(ti->version == 0) {
+        VM* vm = pk_current_vm;
+        // a valid version of a subtype implies valid versions of all its bases
+        if(ti->base_ti && pk_tpversion(ti->base_ti) == 0) return 0;
+        // version tags are never reused, stop caching if they are exhausted
+        if(vm->next_type_version == UINT32_MAX) return 0;
+        ti->version = ++vm->next_type_version;
+    }
+    return ti->version;
+}
+
+void pk_tpmodified(py_TypeInfo* ti) {
+    // if `ti` has no version, none of its subtypes has one
+    if(ti->version == 0) return;
+    ti->version = 0;
+    VM* vm = pk_current_vm;
+    for(int i = 1; i < vm->types.length; i++) {
+        py_TypeInfo* sub = c11__getitem(TypePointer, &vm->types, i).ti;
+        if(sub->version == 0) continue;
+        for(py_TypeInfo* p = sub->base_ti; p; p = p->base_ti) {
+            if(p == ti) {
+                sub->version = 0;
+                break;
+            }
+        }
+    }
+}
+
 PK_INLINE py_ItemRef py_tpfindname(py_Type type, py_Name name) {
     py_TypeInfo* ti = pk_typeinfo(type);
     return pk_tpfindname(ti, name);
@@ -18,7 +109,7 @@ PK_INLINE py_ItemRef py_tpfindname(py_Type type, py_Name name) {
 
 PK_INLINE py_Ref py_tpfindmagic(py_Type t, py_Name name) {
     // assert(py_ismagicname(name));
-    return py_tpfindname(t, name);
+    return pk_tpfindmagic(pk_typeinfo(t), name);
 }
 
 PK_INLINE py_Type py_tpbase(py_Type t) {
@@ -80,6 +171,9 @@ static void py_TypeInfo__common_init(py_Name name,
     if(!dtor && base) dtor = base_ti->dtor;
     self->is_python = is_python;
     self->is_final = is_final;
+    self->version = 0;
+    self->magics_version = 0;
+    self->magics_resolved = 0;
 
     self->getattribute = NULL;
     self->setattribute = NULL;
@@ -170,6 +264,7 @@ void py_tphookattributes(py_Type type,
                          bool (*getunboundmethod)(py_Ref self, py_Name name)) {
     assert(type);
     py_TypeInfo* ti = pk_typeinfo(type);
+    pk_tpmodified(ti);
     ti->getattribute = getattribute;
     ti->setattribute = setattribute;
     ti->delattribute = delattribute;
@@ -12,6 +12,10 @@
 #include <stdbool.h>
 #include <assert.h>
 
+#if PK_ENABLE_PARALLEL_MARK
+#include "pocketpy/common/threads.h"
+#endif
+
 static char* pk_default_importfile(const char* path) {
 #if PK_ENABLE_OS
     FILE* f = fopen(path, "rb");
@@ -82,6 +86,8 @@ void VM__ctor(VM* self) {
     };
     BinTree__ctor(&self->modules, "", py_NIL(), &modules_config);
     c11_vector__ctor(&self->types, sizeof(TypePointer));
+    self->next_type_version = 0;
+    self->next_decl_uid = 0;
 
     self->builtins = NULL;
     self->main = NULL;
@@ -105,11 +111,18 @@ void VM__ctor(VM* self) {
     self->curr_decl_based_function = NULL;
     memset(&self->trace_info, 0, sizeof(TraceInfo));
     memset(&self->watchdog_info, 0, sizeof(WatchdogInfo));
+    self->watchdog_info.fuel = INT64_MAX;
     LineProfiler__ctor(&self->line_profiler);
-
-    FixedMemoryPool__ctor(&self->pool_frame, sizeof(py_Frame), 32);
+#if PK_ENABLE_OPCODE_STATS
+    self->opcode_pairs = PK_MALLOC(sizeof(uint64_t) * OP__COUNT * OP__COUNT);
+    memset(self->opcode_pairs, 0, sizeof(uint64_t) * OP__COUNT * OP__COUNT);
+#endif
+#if PK_ENABLE_HEAP_PROFILER
+    HeapProfiler__ctor(&self->heap_profiler);
+#endif
 
     ManagedHeap__ctor(&self->heap);
+    FrameStack__ctor(&self->frame_stack);
     ValueStack__ctor(&self->stack);
 
     CachedNames__ctor(&self->cached_names);
@@ -207,7 +220,6 @@ void VM__ctor(VM* self) {
     INJECT_BUILTIN_EXC(KeyError, tp_Exception);
 
 #undef INJECT_BUILTIN_EXC
-#undef validate
 
     /* Setup Public Builtin Types */
     py_Type public_types[] = {
@@ -240,6 +252,15 @@ void VM__ctor(VM* self) {
 
     pk__add_module_vmath();
     pk__add_module_array2d();
+
+    // registered last to keep the public type ids stable
+    validate(tp_for_range, pk_newtype("for_range", tp_object, NULL, NULL, false, true));
+    validate(tp_for_list, pk_newtype("for_list", tp_object, NULL, NULL, false, true));
+    validate(tp_for_tuple, pk_newtype("for_tuple", tp_object, NULL, NULL, false, true));
+    validate(tp_for_str, pk_newtype("for_str", tp_object, NULL, NULL, false, true));
+    validate(tp_for_dict, pk_newtype("for_dict", tp_object, NULL, NULL, false, true));
+#undef validate
+
     pk__add_module_colorcvt();
 
     // add modules
@@ -285,13 +306,18 @@ void VM__dtor(VM* self) {
     // reset traceinfo
     py_sys_settrace(NULL, true);
     LineProfiler__dtor(&self->line_profiler);
+#if PK_ENABLE_OPCODE_STATS
+    PK_FREE(self->opcode_pairs);
+#endif
     // destroy all objects
     ManagedHeap__dtor(&self->heap);
+#if PK_ENABLE_HEAP_PROFILER
+    HeapProfiler__dtor(&self->heap_profiler);
+#endif
     // clear frames
     while(self->top_frame)
         VM__pop_frame(self);
     BinTree__dtor(&self->modules);
-    FixedMemoryPool__dtor(&self->pool_frame);
     ValueStack__dtor(&self->stack);
     CachedNames__dtor(&self->cached_names);
     NameDict__dtor(&self->compile_time_funcs);
@@ -395,8 +421,34 @@ bool pk__normalize_index(int* index, int length) {
     return true;
 }
 
-static bool
-    prepare_py_call(py_TValue* buffer, py_Ref argv, py_Ref p1, int kwargc, const FuncDecl* decl) {
+// map the keyword arguments of a call site to locals of `decl`, reusing the last mapping
+static const int16_t*
+    CallCache__kw_layout(CallCache* self, FuncDecl* decl, py_Ref p1, int kwargc) {
+    if(decl->uid != 0 && self->decl_uid == decl->uid) return self->kw_layout;
+    if(decl->uid == 0) {
+        VM* vm = pk_current_vm;
+        if(vm->next_decl_uid == UINT32_MAX) return NULL;
+        decl->uid = ++vm->next_decl_uid;
+    }
+    // invalidate first, a failed refill below leaves the layout half-written
+    self->decl_uid = 0;
+    for(int j = 0; j < kwargc; j++) {
+        py_Name key = (py_Name)py_toint(&p1[2 * j]);
+        int index = c11_smallmap_n2d__get(&decl->kw_to_index, key, -1);
+        // leave invalid keywords to the uncached path for the error message
+        if(index == -1 && decl->starred_kwarg == -1) return NULL;
+        self->kw_layout[j] = index;
+    }
+    self->decl_uid = decl->uid;
+    return self->kw_layout;
+}
+
+static bool prepare_py_call(py_TValue* buffer,
+                            py_Ref argv,
+                            py_Ref p1,
+                            int kwargc,
+                            const FuncDecl* decl,
+                            const int16_t* kw_layout) {
     const CodeObject* co = &decl->code;
     int decl_argc = decl->args.length;
 
@@ -438,7 +490,7 @@ static bool
 
     for(int j = 0; j < kwargc; j++) {
         py_Name key = (py_Name)py_toint(&p1[2 * j]);
-        int index = c11_smallmap_n2d__get(&decl->kw_to_index, key, -1);
+        int index = kw_layout ? kw_layout[j] : c11_smallmap_n2d__get(&decl->kw_to_index, key, -1);
         // if key is an explicit key, set as local variable
         if(index >= 0) {
             buffer[index] = p1[2 * j + 1];
@@ -459,7 +511,8 @@ static bool
     return true;
 }
 
-FrameResult VM__vectorcall(VM* self, uint16_t argc, uint16_t kwargc, bool opcall) {
+FrameResult
+    VM__vectorcall(VM* self, uint16_t argc, uint16_t kwargc, bool opcall, CallCache* cache) {
 #ifndef NDEBUG
     pk_print_stack(self, self->top_frame, (Bytecode){0});
 #endif
@@ -486,7 +539,10 @@ FrameResult VM__vectorcall(VM* self, uint16_t argc, uint16_t kwargc, bool opcall
 
         switch(fn->decl->type) {
             case FuncType_NORMAL: {
-                bool ok = prepare_py_call(self->vectorcall_buffer, argv, p1, kwargc, fn->decl);
+                const int16_t* kw_layout = NULL;
+                if(cache) kw_layout = CallCache__kw_layout(cache, fn->decl, p1, kwargc);
+                py_TValue* buf = self->vectorcall_buffer;
+                bool ok = prepare_py_call(buf, argv, p1, kwargc, fn->decl, kw_layout);
                 if(!ok) return RES_ERROR;
                 // copy buffer back to stack
                 self->stack.sp = argv + co->nlocals;
@@ -534,12 +590,15 @@ FrameResult VM__vectorcall(VM* self, uint16_t argc, uint16_t kwargc, bool opcall
                     return ok ? RES_RETURN : RES_ERROR;
                 }
             case FuncType_GENERATOR: {
-                bool ok = prepare_py_call(self->vectorcall_buffer, argv, p1, kwargc, fn->decl);
+                const int16_t* kw_layout = NULL;
+                if(cache) kw_layout = CallCache__kw_layout(cache, fn->decl, p1, kwargc);
+                py_TValue* buf = self->vectorcall_buffer;
+                bool ok = prepare_py_call(buf, argv, p1, kwargc, fn->decl, kw_layout);
                 if(!ok) return RES_ERROR;
                 // copy buffer back to stack
                 self->stack.sp = argv + co->nlocals;
                 memcpy(argv, self->vectorcall_buffer, co->nlocals * sizeof(py_TValue));
-                py_Frame* frame = Frame__new(co, p0, fn->module, fn->globals, argv, false);
+                py_Frame* frame = Frame__new_detached(co, p0, fn->module, fn->globals, argv);
                 pk_newgenerator(py_retval(), frame, p0, self->stack.sp);
                 self->stack.sp = p0;  // reset the stack
                 return RES_RETURN;
@@ -573,7 +632,7 @@ FrameResult VM__vectorcall(VM* self, uint16_t argc, uint16_t kwargc, bool opcall
         memcpy(self->stack.sp, argv, span * sizeof(py_TValue));
         self->stack.sp += span;
         // [new_f, cls, args..., kwargs...]
-        if(VM__vectorcall(self, argc, kwargc, false) == RES_ERROR) return RES_ERROR;
+        if(VM__vectorcall(self, argc, kwargc, false, cache) == RES_ERROR) return RES_ERROR;
         // by recursively using vectorcall, args and kwargs are consumed
 
         // try __init__
@@ -586,7 +645,7 @@ FrameResult VM__vectorcall(VM* self, uint16_t argc, uint16_t kwargc, bool opcall
             *p0 = *init_f;              // __init__
             p0[1] = self->last_retval;  // self
             // [__init__, self, args..., kwargs...]
-            if(VM__vectorcall(self, argc, kwargc, false) == RES_ERROR) return RES_ERROR;
+            if(VM__vectorcall(self, argc, kwargc, false, cache) == RES_ERROR) return RES_ERROR;
             *py_retval() = p0[1];  // restore the new instance
         }
         // reset the stack
@@ -597,7 +656,7 @@ FrameResult VM__vectorcall(VM* self, uint16_t argc, uint16_t kwargc, bool opcall
     // handle `__call__` overload
     if(pk_loadmethod(p0, __call__)) {
         // [__call__, self, args..., kwargs...]
-        return VM__vectorcall(self, argc, kwargc, opcall);
+        return VM__vectorcall(self, argc, kwargc, opcall, cache);
     }
 
     TypeError("'%t' object is not callable", p0->type);
@@ -629,10 +688,73 @@ static void pk__mark_value_func(py_Ref val, void* ctx) {
     pk__mark_value(val);
 }
 
-void ManagedHeap__mark(ManagedHeap* self) {
+static void PyObject__mark_children(PyObject* obj, c11_vector* p_stack) {
+    if(obj->slots > 0) {
+        py_TValue* p = PyObject__slots(obj);
+        for(int i = 0; i < obj->slots; i++)
+            pk__mark_value(p + i);
+    } else if(obj->slots == -1) {
+        NameDict* dict = PyObject__dict(obj);
+        for(int i = 0; i < dict->capacity; i++) {
+            NameDict_KV* kv = &dict->items[i];
+            if(kv->key == NULL) continue;
+            pk__mark_value(&kv->value);
+        }
+    }
+
+    void* ud = PyObject__userdata(obj);
+    switch(obj->type) {
+        case tp_list: {
+            List* self = ud;
+            for(int i = 0; i < self->length; i++) {
+                py_TValue* val = c11__at(py_TValue, self, i);
+                pk__mark_value(val);
+            }
+            break;
+        }
+        case tp_dict: {
+            Dict* self = ud;
+            for(int i = 0; i < self->entries.length; i++) {
+                DictEntry* entry = c11__at(DictEntry, &self->entries, i);
+                if(py_isnil(&entry->key)) continue;
+                pk__mark_value(&entry->key);
+                pk__mark_value(&entry->val);
+            }
+            break;
+        }
+        case tp_generator: {
+            Generator__gc_mark(ud, p_stack);
+            break;
+        }
+        case tp_function: {
+            function__gc_mark(ud, p_stack);
+            break;
+        }
+        case tp_BaseException: {
+            BaseException* self = ud;
+            pk__mark_value(&self->args);
+            pk__mark_value(&self->inner_exc);
+            c11__foreach(BaseExceptionFrame, &self->stacktrace, frame) {
+                pk__mark_value(&frame->locals);
+                pk__mark_value(&frame->globals);
+            }
+            break;
+        }
+        case tp_code: {
+            CodeObject* self = ud;
+            CodeObject__gc_mark(self, p_stack);
+            break;
+        }
+        case tp_chunked_array2d: {
+            c11_chunked_array2d__mark(ud, p_stack);
+            break;
+        }
+    }
+}
+
+void ManagedHeap__mark_roots(ManagedHeap* self) {
     VM* vm = pk_current_vm;
     c11_vector* p_stack = &self->gc_roots;
-    assert(p_stack->length == 0);
 
     // mark value stack
     for(py_TValue* p = vm->stack.begin; p < vm->stack.sp; p++) {
@@ -672,74 +794,258 @@ void ManagedHeap__mark(ManagedHeap* self) {
     }
     // mark user func
     if(vm->callbacks.gc_mark) vm->callbacks.gc_mark(pk__mark_value_func, p_stack);
-    /*****************************/
+    // frozen objects are not traversed, except the ones written after freezing
+    c11__foreach(PyObject*, &self->frozen_roots, p) PyObject__mark_children(*p, p_stack);
+    ManagedHeap__mark_remembered(self);
+}
+
+void ManagedHeap__mark_remembered(ManagedHeap* self) {
+    c11_vector* p_stack = &self->gc_roots;
+    // unmarked objects referred by marked objects
+    c11__foreach(PyObject*, &self->remembered, p) {
+        (*p)->gc_remembered = false;
+        PyObject__mark_children(*p, p_stack);
+    }
+    c11_vector__clear(&self->remembered);
+}
+
+#if PK_ENABLE_PARALLEL_MARK
+// gray objects visited by the collecting thread alone, small heaps never wake the workers
+#define kParallelMarkMinWork 8192
+// gray objects handed over between threads at once
+#define kParallelMarkPacket 256
+
+PK_THREAD_LOCAL bool pk__mark_atomic;
+
+typedef struct ParallelMark {
+    atomic_flag lock;
+    c11_vector /*T=PyObject_p*/ shared;  // gray objects any thread may take, guarded by `lock`
+    atomic_int idle;                     // threads out of work, changed with `lock` held
+    int nthreads;
+    atomic_int marked;
+} ParallelMark;
+
+// worker threads kept for the lifetime of a heap, they sleep between full collections
+typedef struct MarkWorkers {
+    VM* vm;
+    int count;  // started worker threads, the collecting thread is not included
+    c11_thrd_t threads[PK_GC_MARK_THREADS];
+    c11_mtx_t mutex;
+    c11_cnd_t cond;
+    int job;      // incremented to wake the workers for a new mark, guarded by `mutex`
+    int running;  // workers still in the current mark, guarded by `mutex`
+    bool stop;    // guarded by `mutex`
+    ParallelMark pm;
+} MarkWorkers;
+
+static void ParallelMark__lock(ParallelMark* self) {
+    while(atomic_flag_test_and_set_explicit(&self->lock, memory_order_acquire)) {
+        c11_thrd_yield();
+    }
+}
+
+static void ParallelMark__unlock(ParallelMark* self) {
+    atomic_flag_clear_explicit(&self->lock, memory_order_release);
+}
+
+// move at most `n` gray objects from the top of `from` to `to`
+static void ParallelMark__move(c11_vector* from, c11_vector* to, int n) {
+    n = c11__min(n, from->length);
+    from->length -= n;
+    c11_vector__extend(PyObject*, to, c11__at(PyObject*, from, from->length), n);
+}
+
+static int ParallelMark__drain(ParallelMark* self, c11_vector* p_stack) {
+    int marked = 0;
     while(p_stack->length > 0) {
         PyObject* obj = c11_vector__back(PyObject*, p_stack);
         c11_vector__pop(p_stack);
+        PyObject__mark_children(obj, p_stack);
+        marked++;
+        // hand a packet over to the idle threads
+        if(p_stack->length > kParallelMarkPacket &&
+           atomic_load_explicit(&self->idle, memory_order_relaxed) > 0) {
+            ParallelMark__lock(self);
+            ParallelMark__move(p_stack, &self->shared, kParallelMarkPacket);
+            ParallelMark__unlock(self);
+        }
+    }
+    return marked;
+}
 
-        assert(obj->gc_marked);
-
-        if(obj->slots > 0) {
-            py_TValue* p = PyObject__slots(obj);
-            for(int i = 0; i < obj->slots; i++)
-                pk__mark_value(p + i);
-        } else if(obj->slots == -1) {
-            NameDict* dict = PyObject__dict(obj);
-            for(int i = 0; i < dict->capacity; i++) {
-                NameDict_KV* kv = &dict->items[i];
-                if(kv->key == NULL) continue;
-                pk__mark_value(&kv->value);
-            }
+// wait for a packet of gray objects, returns false once all threads are out of work
+static bool ParallelMark__take(ParallelMark* self, c11_vector* p_stack) {
+    bool is_idle = false;
+    while(true) {
+        ParallelMark__lock(self);
+        if(self->shared.length > 0) {
+            ParallelMark__move(&self->shared, p_stack, kParallelMarkPacket);
+            if(is_idle) atomic_fetch_sub_explicit(&self->idle, 1, memory_order_relaxed);
+            ParallelMark__unlock(self);
+            return true;
         }
+        if(!is_idle) {
+            is_idle = true;
+            atomic_fetch_add_explicit(&self->idle, 1, memory_order_relaxed);
+        }
+        // only busy threads can share more work
+        bool done = atomic_load_explicit(&self->idle, memory_order_relaxed) == self->nthreads;
+        ParallelMark__unlock(self);
+        if(done) return false;
+        c11_thrd_yield();
+    }
+}
 
-        void* ud = PyObject__userdata(obj);
-        switch(obj->type) {
-            case tp_list: {
-                List* self = ud;
-                for(int i = 0; i < self->length; i++) {
-                    py_TValue* val = c11__at(py_TValue, self, i);
-                    pk__mark_value(val);
-                }
-                break;
-            }
-            case tp_dict: {
-                Dict* self = ud;
-                for(int i = 0; i < self->entries.length; i++) {
-                    DictEntry* entry = c11__at(DictEntry, &self->entries, i);
-                    if(py_isnil(&entry->key)) continue;
-                    pk__mark_value(&entry->key);
-                    pk__mark_value(&entry->val);
-                }
-                break;
-            }
-            case tp_generator: {
-                Generator* self = ud;
-                if(self->frame) Frame__gc_mark(self->frame, p_stack);
-                break;
-            }
-            case tp_function: {
-                function__gc_mark(ud, p_stack);
-                break;
-            }
-            case tp_BaseException: {
-                BaseException* self = ud;
-                pk__mark_value(&self->args);
-                pk__mark_value(&self->inner_exc);
-                c11__foreach(BaseExceptionFrame, &self->stacktrace, frame) {
-                    pk__mark_value(&frame->locals);
-                    pk__mark_value(&frame->globals);
-                }
-                break;
-            }
-            case tp_code: {
-                CodeObject* self = ud;
-                CodeObject__gc_mark(self, p_stack);
-                break;
-            }
-            case tp_chunked_array2d: {
-                c11_chunked_array2d__mark(ud, p_stack);
-                break;
-            }
+static void ParallelMark__work(ParallelMark* self, c11_vector* p_stack) {
+    pk__mark_atomic = true;
+    int marked = 0;
+    while(ParallelMark__take(self, p_stack)) {
+        marked += ParallelMark__drain(self, p_stack);
+    }
+    atomic_fetch_add_explicit(&self->marked, marked, memory_order_relaxed);
+    pk__mark_atomic = false;
+}
+
+static c11_thrd_retval_t MarkWorkers__main(void* arg) {
+    MarkWorkers* self = arg;
+    pk_current_vm = self->vm;
+    c11_vector p_stack;
+    c11_vector__ctor(&p_stack, sizeof(PyObject*));
+    c11_mtx_lock(&self->mutex);
+    int job = 0;
+    while(true) {
+        while(self->job == job && !self->stop) {
+            c11_cnd_wait(&self->cond, &self->mutex);
         }
+        if(self->stop) break;
+        job = self->job;
+        c11_mtx_unlock(&self->mutex);
+        ParallelMark__work(&self->pm, &p_stack);
+        c11_mtx_lock(&self->mutex);
+        if(--self->running == 0) c11_cnd_broadcast(&self->cond);
+    }
+    c11_mtx_unlock(&self->mutex);
+    c11_vector__dtor(&p_stack);
+    return (c11_thrd_retval_t)0;
+}
+
+static MarkWorkers* MarkWorkers__new(VM* vm) {
+    MarkWorkers* self = PK_MALLOC(sizeof(MarkWorkers));
+    self->vm = vm;
+    self->count = 0;
+    c11_mtx_init(&self->mutex);
+    c11_cnd_init(&self->cond);
+    self->job = 0;
+    self->running = 0;
+    self->stop = false;
+    atomic_flag_clear(&self->pm.lock);
+    c11_vector__ctor(&self->pm.shared, sizeof(PyObject*));
+    // more threads than processors only add contention
+    int nthreads = c11__min(PK_GC_MARK_THREADS, c11_thrd_processor_count());
+    for(int i = 1; i < nthreads; i++) {
+        if(!c11_thrd_create(&self->threads[self->count], MarkWorkers__main, self)) break;
+        self->count++;
+    }
+    return self;
+}
+
+void ManagedHeap__stop_mark_workers(ManagedHeap* self) {
+    MarkWorkers* workers = self->mark_workers;
+    if(workers == NULL) return;
+    c11_mtx_lock(&workers->mutex);
+    workers->stop = true;
+    c11_cnd_broadcast(&workers->cond);
+    c11_mtx_unlock(&workers->mutex);
+    for(int i = 0; i < workers->count; i++) {
+        c11_thrd_join(workers->threads[i]);
+    }
+    c11_vector__dtor(&workers->pm.shared);
+    c11_cnd_destroy(&workers->cond);
+    c11_mtx_destroy(&workers->mutex);
+    PK_FREE(workers);
+    self->mark_workers = NULL;
+}
+
+// visit all gray objects of `gc_roots` together with the workers
+// returns -1 if there are no workers, e.g. on a single processor
+static int ManagedHeap__mark_parallel(ManagedHeap* self) {
+    if(self->mark_workers == NULL) self->mark_workers = MarkWorkers__new(pk_current_vm);
+    MarkWorkers* workers = self->mark_workers;
+    if(workers->count == 0) return -1;
+    ParallelMark* pm = &workers->pm;
+    c11_vector__swap(&pm->shared, &self->gc_roots);
+    atomic_init(&pm->idle, 0);
+    atomic_init(&pm->marked, 0);
+    // workers not woken yet are not idle, so nobody finishes before all of them join
+    pm->nthreads = workers->count + 1;
+    c11_mtx_lock(&workers->mutex);
+    workers->running = workers->count;
+    workers->job++;
+    c11_cnd_broadcast(&workers->cond);
+    c11_mtx_unlock(&workers->mutex);
+    ParallelMark__work(pm, &self->gc_roots);
+    c11_mtx_lock(&workers->mutex);
+    while(workers->running > 0) {
+        c11_cnd_wait(&workers->cond, &workers->mutex);
+    }
+    c11_mtx_unlock(&workers->mutex);
+    assert(pm->shared.length == 0 && self->gc_roots.length == 0);
+    return atomic_load(&pm->marked);
+}
+#endif
+
+int ManagedHeap__mark_gray(ManagedHeap* self, int budget) {
+    c11_vector* p_stack = &self->gc_roots;
+    int marked = 0;
+    while(p_stack->length > 0 && marked != budget) {
+        PyObject* obj = c11_vector__back(PyObject*, p_stack);
+        c11_vector__pop(p_stack);
+
+        assert(PyObject__is_marked(obj));
+
+        PyObject__mark_children(obj, p_stack);
+        marked++;
+    }
+    return marked;
+}
+
+int ManagedHeap__mark(ManagedHeap* self, bool full) {
+    assert(self->gc_roots.length == 0);
+    ManagedHeap__mark_roots(self);
+#if PK_ENABLE_PARALLEL_MARK
+    if(full) {
+        int marked = ManagedHeap__mark_gray(self, kParallelMarkMinWork);
+        if(self->gc_roots.length > 0) {
+            int res = ManagedHeap__mark_parallel(self);
+            if(res >= 0) return marked + res;
+        }
+        return marked + ManagedHeap__mark_gray(self, -1);
+    }
+#endif
+    return ManagedHeap__mark_gray(self, -1);
+}
+
+static void ManagedHeap__remember_range(py_TValue* begin, py_TValue* end) {
+    for(py_TValue* p = begin; p < end; p++) {
+        // frozen objects existed before, so they are not under construction
+        if(p->is_ptr && !PyObject__is_frozen(p->_obj)) pk__write_barrier(p->_obj);
+    }
+}
+
+void ManagedHeap__remember_temporaries(ManagedHeap* self) {
+    // native functions may keep filling in objects pushed onto the value stack
+    // with raw pointers, so these objects must be rescanned later;
+    // fast locals are written by bytecode only and are skipped to keep this cheap
+    VM* vm = pk_current_vm;
+    py_TValue* end = vm->stack.sp;
+    for(py_Frame* frame = vm->top_frame; frame; frame = frame->f_back) {
+        if(frame->p0 < vm->stack.begin || frame->p0 > end) continue;
+        py_TValue* begin = frame->p0;
+        if(!frame->is_locals_special) begin = frame->locals + frame->co->nlocals;
+        ManagedHeap__remember_range(begin, end);
+        end = frame->p0;
     }
+    ManagedHeap__remember_range(vm->stack.begin, end);
+    ManagedHeap__remember_range(&vm->last_retval, &vm->last_retval + 1);
+    ManagedHeap__remember_range(vm->reg, vm->reg + c11__count_array(vm->reg));
 }
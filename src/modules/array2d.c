@@ -13,6 +13,8 @@ static py_Ref c11_array2d__get(c11_array2d* self, int col, int row) {
 
 static bool c11_array2d__set(c11_array2d* self, int col, int row, py_Ref value) {
     self->data[row * self->header.n_cols + col] = *value;
+    // `data` points to the slots of the owner
+    pk__write_barrier((PyObject*)((char*)self->data - offsetof(PyObject, flex)));
     return true;
 }
 
@@ -921,6 +923,11 @@ static void register_array2d_view(py_Ref mod) {
 #include "pocketpy/xmacros/smallmap.h"
 #undef SMALLMAP_T__SOURCE
 
+// `chunked_array2d` objects have no slots
+static PyObject* c11_chunked_array2d__owner(c11_chunked_array2d* self) {
+    return (PyObject*)((char*)self - offsetof(PyObject, flex));
+}
+
 static py_TValue* c11_chunked_array2d__new_chunk(c11_chunked_array2d* self, c11_vec2i pos) {
 #ifndef NDEBUG
     bool exists = c11_chunked_array2d_chunks__contains(&self->chunks, pos);
@@ -941,6 +948,7 @@ static py_TValue* c11_chunked_array2d__new_chunk(c11_chunked_array2d* self, c11_
     }
     memset(&data[1], 0, sizeof(py_TValue) * (chunk_numel - 1));
     c11_chunked_array2d_chunks__set(&self->chunks, pos, data);
+    pk__write_barrier(c11_chunked_array2d__owner(self));
     self->last_visited.key = pos;
     self->last_visited.value = data;
     return data;
@@ -1010,6 +1018,7 @@ bool c11_chunked_array2d__set(c11_chunked_array2d* self, int col, int row, py_Re
         if(data == NULL) return false;
     }
     data[1 + local_pos.y * self->chunk_size + local_pos.x] = *value;
+    pk__write_barrier(c11_chunked_array2d__owner(self));
     return true;
 }
 
@@ -90,7 +90,12 @@ static bool disassemble(CodeObject* co) {
                 }
                 case OP_LOAD_FAST:
                 case OP_STORE_FAST:
-                case OP_DELETE_FAST: {
+                case OP_DELETE_FAST:
+                case OP_LOAD_FAST__LOAD_FAST:
+                case OP_LOAD_FAST__LOAD_SMALL_INT:
+                case OP_LOAD_FAST__LOAD_SMALL_INT__BINARY_ADD:
+                case OP_LOAD_FAST__LOAD_SMALL_INT__BINARY_SUB:
+                case OP_STORE_FAST__LOAD_FAST: {
                     py_Name name = c11__getitem(py_Name, &co->varnames, byte.arg);
                     pk_sprintf(&ss, " (%n)", name);
                     break;
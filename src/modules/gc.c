@@ -2,13 +2,131 @@
 #include "pocketpy/interpreter/vm.h"
 
 static bool gc_collect(int argc, py_Ref argv) {
-    PY_CHECK_ARGC(0);
+    PY_CHECK_ARGC(1);
+    PY_CHECK_ARG_TYPE(0, tp_int);
     ManagedHeap* heap = &pk_current_vm->heap;
-    int res = ManagedHeap__collect(heap);
+    int res;
+    // generation 0 only collects young objects
+    if(py_toint(argv) == 0) {
+        res = ManagedHeap__collect_young(heap);
+    } else {
+        res = ManagedHeap__collect(heap);
+    }
     py_newint(py_retval(), res);
     return true;
 }
 
+static bool gc_step(int argc, py_Ref argv) {
+    PY_CHECK_ARGC(1);
+    PY_CHECK_ARG_TYPE(0, tp_int);
+    int budget_us = py_toint(argv);
+    py_newbool(py_retval(), ManagedHeap__step(&pk_current_vm->heap, budget_us));
+    return true;
+}
+
+static bool gc_freeze(int argc, py_Ref argv) {
+    PY_CHECK_ARGC(0);
+    ManagedHeap__freeze(&pk_current_vm->heap);
+    py_newnone(py_retval());
+    return true;
+}
+
+static bool gc_unfreeze(int argc, py_Ref argv) {
+    PY_CHECK_ARGC(0);
+    ManagedHeap__unfreeze(&pk_current_vm->heap);
+    py_newnone(py_retval());
+    return true;
+}
+
+static bool gc_get_freeze_count(int argc, py_Ref argv) {
+    PY_CHECK_ARGC(0);
+    py_newint(py_retval(), pk_current_vm->heap.frozen_count);
+    return true;
+}
+
+static void gc_setstat(py_Ref dict, const char* key, py_i64 val) {
+    py_Ref tmp = py_pushtmp();
+    py_newint(tmp, val);
+    py_dict_setitem_by_str(dict, key, tmp);
+    py_pop();
+}
+
+static void gc_newstats(ManagedHeap* heap, py_OutRef out, const GCStats* stats) {
+    py_newdict(out);
+    gc_setstat(out, "generation", stats->generation);
+    py_Ref tmp = py_pushtmp();
+    py_newbool(tmp, stats->incremental);
+    py_dict_setitem_by_str(out, "incremental", tmp);
+    gc_setstat(out, "start_ns", stats->start_ns);
+    gc_setstat(out, "mark_ns", stats->mark_ns);
+    gc_setstat(out, "sweep_ns", stats->sweep_ns);
+    gc_setstat(out, "marked", stats->marked);
+    // block size -> freed objects, pools that freed nothing are omitted
+    int freed = stats->freed_large;
+    py_newdict(tmp);
+    for(int i = 0; i < kMultiPoolCount; i++) {
+        if(stats->freed_small[i] == 0) continue;
+        freed += stats->freed_small[i];
+        py_Ref count = py_pushtmp();
+        py_newint(count, stats->freed_small[i]);
+        py_dict_setitem_by_int(tmp, heap->small_objects.pools[i].block_size, count);
+        py_pop();
+    }
+    py_dict_setitem_by_str(out, "freed_pools", tmp);
+    py_pop();
+    gc_setstat(out, "freed_large", stats->freed_large);
+    gc_setstat(out, "freed", freed);
+    gc_setstat(out, "threshold", stats->threshold);
+}
+
+static bool gc_get_stats(int argc, py_Ref argv) {
+    PY_CHECK_ARGC(0);
+    ManagedHeap* heap = &pk_current_vm->heap;
+    int length = c11__min(heap->gc_stats_count, kGCStatsLength);
+    py_Ref res = py_pushtmp();
+    py_newlistn(res, length);
+    // oldest first
+    for(int i = 0; i < length; i++) {
+        int index = (heap->gc_stats_count - length + i) % kGCStatsLength;
+        gc_newstats(heap, py_list_getitem(res, i), &heap->gc_stats[index]);
+    }
+    py_assign(py_retval(), res);
+    py_pop();
+    return true;
+}
+
+void ManagedHeap__fire_callbacks(ManagedHeap* self, const char* phase, const GCStats* stats) {
+    if(self->gc_in_callbacks) return;
+    py_GlobalRef mod = py_getmodule("gc");
+    if(mod == NULL) return;
+    py_ItemRef callbacks = py_getdict(mod, py_name("callbacks"));
+    if(callbacks == NULL || !py_islist(callbacks) || py_list_len(callbacks) == 0) return;
+    self->gc_in_callbacks = true;
+    // a collection may start in the middle of an instruction, keep its return value
+    py_push(py_retval());
+    // [retval, callbacks, phase, info, f]
+    py_push(callbacks);
+    py_Ref list = py_peek(-1);
+    py_Ref args = py_pushtmp();
+    py_pushtmp();
+    py_newstr(&args[0], phase);
+    gc_newstats(self, &args[1], stats);
+    py_Ref f = py_pushtmp();
+    // the list may be changed by the callbacks
+    for(int i = 0; i < py_list_len(list); i++) {
+        *f = *py_list_getitem(list, i);
+        py_StackRef p0 = py_peek(0);
+        if(!py_call(f, 2, args)) {
+            py_printexc();
+            py_clearexc(p0);
+        }
+    }
+    py_shrink(4);
+    py_assign(py_retval(), py_peek(-1));
+    py_pop();
+    self->gc_in_callbacks = false;
+}
+
 static bool gc_enable(int argc, py_Ref argv) {
     PY_CHECK_ARGC(0);
     ManagedHeap* heap = &pk_current_vm->heap;
@@ -35,13 +153,36 @@ static bool gc_isenabled(int argc, py_Ref argv) {
 void pk__add_module_gc() {
     py_Ref mod = py_newmodule("gc");
 
-    py_bindfunc(mod, "collect", gc_collect);
+    py_bind(mod, "collect(generation=2)", gc_collect);
+    py_bind(mod, "step(budget_us=1000)", gc_step);
+    py_bindfunc(mod, "freeze", gc_freeze);
+    py_bindfunc(mod, "unfreeze", gc_unfreeze);
+    py_bindfunc(mod, "get_freeze_count", gc_get_freeze_count);
     py_bindfunc(mod, "enable", gc_enable);
     py_bindfunc(mod, "disable", gc_disable);
     py_bindfunc(mod, "isenabled", gc_isenabled);
+    py_bindfunc(mod, "get_stats", gc_get_stats);
+
+    // called with ("start" | "stop", info) around every collection
+    py_newlist(py_emplacedict(mod, py_name("callbacks")));
 }
 
 int py_gc_collect() {
     ManagedHeap* heap = &pk_current_vm->heap;
     return ManagedHeap__collect(heap);
+}
+
+bool py_gc_step(int budget_us) {
+    ManagedHeap* heap = &pk_current_vm->heap;
+    return ManagedHeap__step(heap, budget_us);
+}
+
+void py_gc_freeze() {
+    ManagedHeap* heap = &pk_current_vm->heap;
+    ManagedHeap__freeze(heap);
+}
+
+void py_gc_unfreeze() {
+    ManagedHeap* heap = &pk_current_vm->heap;
+    ManagedHeap__unfreeze(heap);
 }
\ No newline at end of file
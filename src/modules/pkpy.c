@@ -51,7 +51,9 @@ static bool pkpy_memory_usage(int argc, py_Ref argv) {
     c11_sbuf__write_cstr(&buf, "== heap.gc ==\n");
     pk_sprintf(&buf, "gc_counter=%d\n", heap->gc_counter);
     pk_sprintf(&buf, "gc_threshold=%d", heap->gc_threshold);
-    // c11_sbuf__write_cstr(&buf, "== vm.pool_frame ==\n");
+    c11_sbuf__write_cstr(&buf, "\n== vm.frame_stack ==\n");
+    FrameStack* fs = &pk_current_vm->frame_stack;
+    pk_sprintf(&buf, "used=%d/%d", (int)(fs->sp - fs->begin), PK_VM_FRAME_STACK_SIZE);
     c11_sbuf__py_submit(&buf, py_retval());
     c11_string__delete(small_objects_usage);
     return true;
@@ -82,12 +84,23 @@ static bool pkpy_currentvm(int argc, py_Ref argv) {
 #if PK_ENABLE_WATCHDOG
 void py_watchdog_begin(py_i64 timeout) {
     WatchdogInfo* info = &pk_current_vm->watchdog_info;
+    info->fuel = PK_WATCHDOG_CLOCK_INTERVAL;
     info->max_reset_time = clock() + (timeout * (CLOCKS_PER_SEC / 1000));
+    info->is_fuel_limited = false;
+}
+
+void py_watchdog_begin_fuel(py_i64 fuel) {
+    WatchdogInfo* info = &pk_current_vm->watchdog_info;
+    info->fuel = fuel;
+    info->max_reset_time = 0;
+    info->is_fuel_limited = true;
 }
 
 void py_watchdog_end() {
     WatchdogInfo* info = &pk_current_vm->watchdog_info;
+    info->fuel = INT64_MAX;
     info->max_reset_time = 0;
+    info->is_fuel_limited = false;
 }
 
 static bool pkpy_watchdog_begin(int argc, py_Ref argv) {
@@ -98,6 +111,14 @@ static bool pkpy_watchdog_begin(int argc, py_Ref argv) {
     return true;
 }
 
+static bool pkpy_watchdog_begin_fuel(int argc, py_Ref argv) {
+    PY_CHECK_ARGC(1);
+    PY_CHECK_ARG_TYPE(0, tp_int);
+    py_watchdog_begin_fuel(py_toint(argv));
+    py_newnone(py_retval());
+    return true;
+}
+
 static bool pkpy_watchdog_end(int argc, py_Ref argv) {
     PY_CHECK_ARGC(0);
     py_watchdog_end();
@@ -106,6 +127,174 @@ static bool pkpy_watchdog_end(int argc, py_Ref argv) {
 }
 #endif
 
+#if PK_ENABLE_OPCODE_STATS
+static bool pkpy_opcode_pairs(int argc, py_Ref argv) {
+    PY_CHECK_ARGC(0);
+    VM* vm = pk_current_vm;
+    py_Ref res = py_pushtmp();
+    py_newlist(res);
+    for(int i = 0; i < OP__COUNT; i++) {
+        for(int j = 0; j < OP__COUNT; j++) {
+            uint64_t count = vm->opcode_pairs[i][j];
+            if(count == 0) continue;
+            py_Ref p = py_newtuple(py_list_emplace(res), 3);
+            py_newstr(&p[0], pk_opname(i));
+            py_newstr(&p[1], pk_opname(j));
+            py_newint(&p[2], (py_i64)count);
+        }
+    }
+    py_assign(py_retval(), res);
+    py_pop();
+    return true;
+}
+#endif
+
+#if PK_ENABLE_HEAP_PROFILER
+static void pkpy_census_newrow(py_OutRef out, py_i64 count, py_i64 bytes, py_i64 allocated) {
+    py_Ref p = py_newtuple(out, 3);
+    py_newint(&p[0], count);
+    py_newint(&p[1], bytes);
+    py_newint(&p[2], allocated);
+}
+
+static bool pkpy_census_getrow(py_Ref row, py_i64 out[3]) {
+    if(!py_checktype(row, tp_tuple)) return false;
+    if(py_tuple_len(row) != 3) return ValueError("expected a (count, bytes, allocated) tuple");
+    for(int i = 0; i < 3; i++) {
+        py_Ref item = py_tuple_getitem(row, i);
+        if(!py_checkint(item)) return false;
+        out[i] = py_toint(item);
+    }
+    return true;
+}
+
+typedef struct CensusDiffContext {
+    py_Ref other;
+    py_Ref out;
+    bool is_since;  // iterating the old census, `other` is the new one
+} CensusDiffContext;
+
+static bool pkpy_census_diffrow(py_Ref key, py_Ref val, void* ctx_) {
+    CensusDiffContext* ctx = ctx_;
+    py_i64 row[3], other_row[3] = {0, 0, 0};
+    if(!pkpy_census_getrow(val, row)) return false;
+    int res = py_dict_getitem(ctx->other, key);
+    if(res == -1) return false;
+    if(ctx->is_since) {
+        // rows found in both censuses are handled when iterating the new one
+        if(res == 1) return true;
+        for(int i = 0; i < 3; i++) {
+            row[i] = -row[i];
+        }
+    } else if(res == 1) {
+        if(!pkpy_census_getrow(py_retval(), other_row)) return false;
+    }
+    for(int i = 0; i < 3; i++) {
+        row[i] -= other_row[i];
+    }
+    if(row[0] == 0 && row[1] == 0 && row[2] == 0) return true;
+    py_Ref tmp = py_pushtmp();
+    pkpy_census_newrow(tmp, row[0], row[1], row[2]);
+    bool ok = py_dict_setitem(ctx->out, key, tmp);
+    py_pop();
+    return ok;
+}
+
+// out[name] = {key: curr[name][key] - since[name].get(key, (0, 0, 0))}, unchanged rows are dropped
+static bool pkpy_census_diff(py_Ref curr, py_Ref since, const char* name, py_Ref out) {
+    py_Ref curr_rows = py_pushtmp();
+    py_Ref since_rows = py_pushtmp();
+    py_Ref out_rows = py_pushtmp();
+    bool ok = false;
+    if(py_dict_getitem_by_str(curr, name) != 1) goto __ERROR;
+    *curr_rows = *py_retval();
+    int res = py_dict_getitem_by_str(since, name);
+    if(res == -1) goto __ERROR;
+    if(res == 0) {
+        py_newstr(out_rows, name);
+        KeyError(out_rows);
+        goto __ERROR;
+    }
+    *since_rows = *py_retval();
+    if(!py_checktype(since_rows, tp_dict)) goto __ERROR;
+    py_newdict(out_rows);
+    CensusDiffContext ctx = {since_rows, out_rows, false};
+    if(!py_dict_apply(curr_rows, pkpy_census_diffrow, &ctx)) goto __ERROR;
+    ctx = (CensusDiffContext){curr_rows, out_rows, true};
+    if(!py_dict_apply(since_rows, pkpy_census_diffrow, &ctx)) goto __ERROR;
+    ok = py_dict_setitem_by_str(out, name, out_rows);
+__ERROR:
+    py_shrink(3);
+    return ok;
+}
+
+bool py_heap_census(py_Ref since) {
+    VM* vm = pk_current_vm;
+    HeapProfiler* self = &vm->heap_profiler;
+    if(since && !py_checktype(since, tp_dict)) return false;
+    if(vm->heap.gc_in_callbacks) return RuntimeError("heap_census() cannot run in gc.callbacks");
+    // only count live objects
+    ManagedHeap__collect(&vm->heap);
+    c11_vector types, sites;
+    c11_vector__ctor(&types, sizeof(HeapCensusRow));
+    c11_vector__ctor(&sites, sizeof(HeapCensusRow));
+    HeapProfiler__census(self, &vm->heap, &types, &sites);
+
+    py_Ref res = py_pushtmp();
+    py_Ref rows = py_pushtmp();
+    py_Ref tmp = py_pushtmp();
+    py_newdict(res);
+    bool ok = true;
+
+    py_newdict(rows);
+    for(int i = 0; i < types.length && ok; i++) {
+        HeapCensusRow row = c11__getitem(HeapCensusRow, &types, i);
+        py_i64 allocated = c11__getitem(py_i64, &self->allocated, i);
+        if(row.count == 0 && allocated == 0) continue;
+        pkpy_census_newrow(tmp, row.count, row.bytes, allocated);
+        ok = py_dict_setitem(rows, py_tpobject(i), tmp);
+    }
+    if(ok) ok = py_dict_setitem_by_str(res, "types", rows);
+
+    py_newdict(rows);
+    for(int i = 0; i < sites.length && ok; i++) {
+        HeapCensusRow row = c11__getitem(HeapCensusRow, &sites, i);
+        HeapSite* site = c11__at(HeapSite, &self->sites, i);
+        if(row.count == 0 && site->allocated == 0) continue;
+        py_Ref key = py_pushtmp();
+        py_Ref p = py_newtuple(key, 2);
+        py_newint(&p[1], site->lineno);
+        py_newstr(&p[0], site->src ? site->src->filename->data : "<native>");
+        pkpy_census_newrow(tmp, row.count, row.bytes, site->allocated);
+        ok = py_dict_setitem(rows, key, tmp);
+        py_pop();
+    }
+    if(ok) ok = py_dict_setitem_by_str(res, "sites", rows);
+    c11_vector__dtor(&types);
+    c11_vector__dtor(&sites);
+
+    if(ok && since) {
+        py_newdict(rows);
+        ok = pkpy_census_diff(res, since, "types", rows) &&
+             pkpy_census_diff(res, since, "sites", rows);
+        *res = *rows;
+    }
+    if(ok) py_assign(py_retval(), res);
+    py_shrink(3);
+    return ok;
+}
+
+static bool pkpy_heap_census(int argc, py_Ref argv) {
+    if(argc > 1) return TypeError("heap_census() takes at most 1 argument");
+    py_Ref since = (argc == 1 && !py_isnone(argv)) ? argv : NULL;
+    return py_heap_census(since);
+}
+#else
+bool py_heap_census(py_Ref since) {
+    return py_exception(tp_NotImplementedError, "heap_census() requires PK_ENABLE_HEAP_PROFILER");
+}
+#endif
+
 #if PK_ENABLE_THREADS
 
 typedef struct c11_ComputeThread c11_ComputeThread;
@@ -545,9 +734,18 @@ void pk__add_module_pkpy() {
 
 #if PK_ENABLE_WATCHDOG
     py_bindfunc(mod, "watchdog_begin", pkpy_watchdog_begin);
+    py_bindfunc(mod, "watchdog_begin_fuel", pkpy_watchdog_begin_fuel);
     py_bindfunc(mod, "watchdog_end", pkpy_watchdog_end);
 #endif
 
+#if PK_ENABLE_OPCODE_STATS
+    py_bindfunc(mod, "opcode_pairs", pkpy_opcode_pairs);
+#endif
+
+#if PK_ENABLE_HEAP_PROFILER
+    py_bindfunc(mod, "heap_census", pkpy_heap_census);
+#endif
+
 #if PK_ENABLE_THREADS
     pk_ComputeThread__register(mod);
 #endif
@@ -563,8 +761,16 @@ void pk__add_module_pkpy() {
     pkpy_configmacros_add(configmacros, "PK_ENABLE_THREADS", PK_ENABLE_THREADS);
     pkpy_configmacros_add(configmacros, "PK_ENABLE_DETERMINISM", PK_ENABLE_DETERMINISM);
     pkpy_configmacros_add(configmacros, "PK_ENABLE_WATCHDOG", PK_ENABLE_WATCHDOG);
+    pkpy_configmacros_add(configmacros, "PK_ENABLE_COMPUTED_GOTO", PK_ENABLE_COMPUTED_GOTO);
+    pkpy_configmacros_add(configmacros, "PK_ENABLE_OPCODE_STATS", PK_ENABLE_OPCODE_STATS);
+    pkpy_configmacros_add(configmacros, "PK_ENABLE_GENERATIONAL_GC", PK_ENABLE_GENERATIONAL_GC);
+    pkpy_configmacros_add(configmacros, "PK_ENABLE_INCREMENTAL_GC", PK_ENABLE_INCREMENTAL_GC);
+    pkpy_configmacros_add(configmacros, "PK_ENABLE_HEAP_PROFILER", PK_ENABLE_HEAP_PROFILER);
+    pkpy_configmacros_add(configmacros, "PK_ENABLE_PARALLEL_MARK", PK_ENABLE_PARALLEL_MARK);
+    pkpy_configmacros_add(configmacros, "PK_ENABLE_COMPACT_TVALUE", PK_ENABLE_COMPACT_TVALUE);
     pkpy_configmacros_add(configmacros, "PK_GC_MIN_THRESHOLD", PK_GC_MIN_THRESHOLD);
     pkpy_configmacros_add(configmacros, "PK_VM_STACK_SIZE", PK_VM_STACK_SIZE);
+    pkpy_configmacros_add(configmacros, "PK_VM_FRAME_STACK_SIZE", PK_VM_FRAME_STACK_SIZE);
 }
 
 #undef DEF_TVALUE_METHODS
\ No newline at end of file
@@ -1,9 +1,8 @@
 #include "pocketpy/interpreter/vm.h"
 #include "pocketpy/pocketpy.h"
+#include "pocketpy/interpreter/modules.h"
 #include <time.h>
 
-int64_t time_ns();  // from random.c
-
 /* https://github.com/clibs/mt19937ar
 
 Copyright (c) 2011 Mutsuo Saito, Makoto Matsumoto, Hiroshima
@@ -1,11 +1,12 @@
 #include "pocketpy/pocketpy.h"
+#include "pocketpy/interpreter/modules.h"
 #include <time.h>
 #include <assert.h>
 
 #define NANOS_PER_SEC 1000000000
 
 #ifndef __circle__
-    int64_t time_ns() {
+    int64_t time_ns(void) {
         struct timespec tms;
     #ifdef CLOCK_REALTIME
         clock_gettime(CLOCK_REALTIME, &tms);
@@ -20,7 +21,7 @@
         return nanos;
     }
 #else
-    int64_t time_ns() {
+    int64_t time_ns(void) {
         return 0;
     }
 #endif
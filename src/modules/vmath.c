@@ -55,6 +55,27 @@ c11_vec2i py_tovec2i(py_Ref self) {
     return self->_vec2i;
 }
 
+#if PK_ENABLE_COMPACT_TVALUE
+void py_newvec3(py_OutRef out, c11_vec3 v) {
+    c11_vec3* ud = py_newobject(out, tp_vec3, 0, sizeof(c11_vec3));
+    *ud = v;
+}
+
+c11_vec3 py_tovec3(py_Ref self) {
+    assert(self->type == tp_vec3);
+    return *(c11_vec3*)py_touserdata(self);
+}
+
+void py_newvec3i(py_OutRef out, c11_vec3i v) {
+    c11_vec3i* ud = py_newobject(out, tp_vec3i, 0, sizeof(c11_vec3i));
+    *ud = v;
+}
+
+c11_vec3i py_tovec3i(py_Ref self) {
+    assert(self->type == tp_vec3i);
+    return *(c11_vec3i*)py_touserdata(self);
+}
+#else
 void py_newvec3(py_OutRef out, c11_vec3 v) {
     out->type = tp_vec3;
     out->is_ptr = false;
@@ -76,6 +97,7 @@ c11_vec3i py_tovec3i(py_Ref self) {
     assert(self->type == tp_vec3i);
     return self->_vec3i;
 }
+#endif
 
 c11_mat3x3* py_newmat3x3(py_OutRef out) {
     return py_newobject(out, tp_mat3x3, 0, sizeof(c11_mat3x3));
@@ -14,13 +14,15 @@ void Bytecode__set_signed_arg(Bytecode* self, int arg) {
 bool Bytecode__is_forward_jump(const Bytecode* self) {
     Opcode op = self->op;
     return (op >= OP_JUMP_FORWARD && op <= OP_LOOP_BREAK) ||
-           (op == OP_FOR_ITER || op == OP_FOR_ITER_YIELD_VALUE);
+           (op == OP_FOR_ITER || op == OP_FOR_ITER_YIELD_VALUE) ||
+           (op >= OP_FOR_ITER_RANGE && op <= OP_FOR_ITER_DICT);
 }
 
 static void FuncDecl__dtor(FuncDecl* self) {
     CodeObject__dtor(&self->code);
     c11_vector__dtor(&self->args);
     c11_vector__dtor(&self->kwargs);
+    c11_vector__dtor(&self->captures);
     c11_smallmap_n2d__dtor(&self->kw_to_index);
 }
 
@@ -36,11 +38,13 @@ FuncDecl_ FuncDecl__rcnew(SourceData_ src, c11_sv name) {
     self->starred_arg = -1;
     self->starred_kwarg = -1;
     self->nested = false;
+    c11_vector__ctor(&self->captures, sizeof(FuncDeclCapture));
 
     self->docstring = NULL;
     self->type = FuncType_UNSET;
 
     c11_smallmap_n2d__ctor(&self->kw_to_index);
+    self->uid = 0;
     return self;
 }
 
@@ -132,8 +136,14 @@ void CodeObject__ctor(CodeObject* self, SourceData_ src, c11_sv name) {
     c11_smallmap_n2d__ctor(&self->names_inv);
 
     c11_vector__ctor(&self->blocks, sizeof(CodeBlock));
+    c11_vector__ctor(&self->exc_handlers, sizeof(ExceptionHandler));
     c11_vector__ctor(&self->func_decls, sizeof(FuncDecl_));
 
+    c11_vector__ctor(&self->attr_caches, sizeof(AttrCache));
+    c11_vector__ctor(&self->global_caches, sizeof(GlobalCache));
+    c11_vector__ctor(&self->call_caches, sizeof(CallCache));
+    c11_vector__ctor(&self->call_kw_layouts, sizeof(int16_t));
+
     self->start_line = -1;
     self->end_line = -1;
 
@@ -156,12 +166,18 @@ void CodeObject__dtor(CodeObject* self) {
     c11_smallmap_n2d__dtor(&self->names_inv);
 
     c11_vector__dtor(&self->blocks);
+    c11_vector__dtor(&self->exc_handlers);
 
     for(int i = 0; i < self->func_decls.length; i++) {
         FuncDecl_ decl = c11__getitem(FuncDecl_, &self->func_decls, i);
         PK_DECREF(decl);
     }
     c11_vector__dtor(&self->func_decls);
+
+    c11_vector__dtor(&self->attr_caches);
+    c11_vector__dtor(&self->global_caches);
+    c11_vector__dtor(&self->call_caches);
+    c11_vector__dtor(&self->call_kw_layouts);
 }
 
 void Function__ctor(Function* self, FuncDecl_ decl, py_GlobalRef module, py_Ref globals) {
@@ -169,7 +185,6 @@ void Function__ctor(Function* self, FuncDecl_ decl, py_GlobalRef module, py_Ref
     self->decl = decl;
     self->module = module;
     self->globals = globals;
-    self->closure = NULL;
     self->clazz = NULL;
     self->cfunc = NULL;
 }
@@ -193,10 +208,60 @@ int CodeObject__add_name(CodeObject* self, py_Name name) {
     return index;
 }
 
+void CodeObject__init_caches(CodeObject* self) {
+    Bytecode* codes = self->codes.data;
+    BytecodeEx* codes_ex = self->codes_ex.data;
+    c11_vector__clear(&self->attr_caches);
+    c11_vector__clear(&self->global_caches);
+    c11_vector__clear(&self->call_caches);
+    c11_vector__clear(&self->call_kw_layouts);
+    for(int i = 0; i < self->codes.length; i++) {
+        switch(codes[i].op) {
+            case OP_LOAD_ATTR:
+            case OP_LOAD_METHOD:
+            case OP_STORE_ATTR: {
+                codes_ex[i].icache = self->attr_caches.length;
+                AttrCache* cache = c11_vector__emplace(&self->attr_caches);
+                memset(cache, 0, sizeof(AttrCache));
+                break;
+            }
+            case OP_LOAD_GLOBAL:
+            case OP_LOAD_NONLOCAL:
+            case OP_LOAD_CLOSURE: {
+                codes_ex[i].icache = self->global_caches.length;
+                GlobalCache* cache = c11_vector__emplace(&self->global_caches);
+                memset(cache, 0, sizeof(GlobalCache));
+                break;
+            }
+            case OP_CALL: {
+                int kwargc = codes[i].arg >> 8;
+                if(kwargc == 0) {
+                    codes_ex[i].icache = -1;
+                    break;
+                }
+                codes_ex[i].icache = self->call_caches.length;
+                CallCache* cache = c11_vector__emplace(&self->call_caches);
+                cache->decl_uid = 0;
+                // offset for now, turned into a pointer below
+                cache->kw_layout = (int16_t*)(intptr_t)self->call_kw_layouts.length;
+                for(int j = 0; j < kwargc; j++) {
+                    c11_vector__push(int16_t, &self->call_kw_layouts, -1);
+                }
+                break;
+            }
+            default: codes_ex[i].icache = -1; break;
+        }
+    }
+    // `call_kw_layouts` does not grow anymore
+    c11__foreach(CallCache, &self->call_caches, cache) {
+        intptr_t offset = (intptr_t)cache->kw_layout;
+        cache->kw_layout = (int16_t*)self->call_kw_layouts.data + offset;
+    }
+}
+
 void Function__dtor(Function* self) {
     // printf("%s() in %s freed!\n", self->decl->code.name->data,
     // self->decl->code.src->filename->data);
     PK_DECREF(self->decl);
-    if(self->closure) NameDict__delete(self->closure);
     memset(self, 0, sizeof(Function));
 }
\ No newline at end of file
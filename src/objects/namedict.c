@@ -95,6 +95,13 @@ py_TValue* NameDict__try_get(NameDict* self, py_Name key) {
     return &self->items[i].value;
 }
 
+int NameDict__index(NameDict* self, py_Name key) {
+    bool ok;
+    uintptr_t i;
+    HASH_PROBE_0(key, ok, i);
+    return ok ? (int)i : -1;
+}
+
 bool NameDict__contains(NameDict* self, py_Name key) {
     bool ok;
     uintptr_t i;
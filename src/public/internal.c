@@ -24,13 +24,18 @@ void py_initialize() {
     }
 
     pk_names_initialize();
+    pk_magicslots_initialize();
 
     // check endianness
     int x = 1;
     bool is_little_endian = *(char*)&x == 1;
     if(!is_little_endian) c11__abort("is_little_endian != true");
 
+#if PK_ENABLE_COMPACT_TVALUE
+    static_assert(sizeof(py_TValue) == 16, "sizeof(py_TValue) != 16");
+#else
     static_assert(sizeof(py_TValue) == 24, "sizeof(py_TValue) != 24");
+#endif
     static_assert(offsetof(py_TValue, extra) == 4, "offsetof(py_TValue, extra) != 4");
 
     pk_current_vm = pk_all_vm[0] = &pk_default_vm;
@@ -179,7 +184,7 @@ bool py_callcfunc(py_CFunction f, int argc, py_Ref argv) {
 #endif
 
 bool py_vectorcall(uint16_t argc, uint16_t kwargc) {
-    return VM__vectorcall(pk_current_vm, argc, kwargc, false) != RES_ERROR;
+    return VM__vectorcall(pk_current_vm, argc, kwargc, false, NULL) != RES_ERROR;
 }
 
 PK_INLINE py_Ref py_retval() { return &pk_current_vm->last_retval; }
@@ -265,6 +270,48 @@ bool pk_loadmethod(py_StackRef self, py_Name name) {
     return false;
 }
 
+bool pk_loadmethod_cached(py_StackRef self, py_Name name, AttrCache* cache) {
+    py_Type type = self->type;
+    py_TypeInfo* ti = pk_typeinfo(type);
+    if(cache->type == type && cache->version == ti->version && cache->version != 0) {
+        py_Ref cls_var = cache->cls_var;
+        switch(cache->kind) {
+            case AttrCacheKind_METHOD:
+                self[1] = self[0];
+                self[0] = *cls_var;
+                return true;
+            case AttrCacheKind_STATICMETHOD:
+                self[0] = *py_getslot(cls_var, 0);
+                self[1] = *py_NIL();
+                return true;
+            case AttrCacheKind_CLASSMETHOD:
+                self[0] = *py_getslot(cls_var, 0);
+                self[1] = ti->self;
+                return true;
+            default: break;
+        }
+    }
+    if(!pk_loadmethod(self, name)) return false;
+    // only plain receivers are cached, `__new__` and super() proxies take the slow path
+    cache->type = 0;
+    if(name == __new__ || type == tp_super || ti->getunboundmethod) return true;
+    py_ItemRef cls_var = pk_tpfindname(ti, name);
+    if(cls_var == NULL) return true;
+    switch(cls_var->type) {
+        case tp_function:
+        case tp_nativefunc: cache->kind = AttrCacheKind_METHOD; break;
+        case tp_staticmethod: cache->kind = AttrCacheKind_STATICMETHOD; break;
+        case tp_classmethod: cache->kind = AttrCacheKind_CLASSMETHOD; break;
+        default: return true;
+    }
+    uint32_t version = pk_tpversion(ti);
+    if(version == 0) return true;
+    cache->type = type;
+    cache->version = version;
+    cache->cls_var = cls_var;
+    return true;
+}
+
 bool py_tpcall(py_Type type, int argc, py_Ref argv) {
     return py_call(py_tpobject(type), argc, argv);
 }
@@ -39,6 +39,7 @@ py_Ref py_newmodule(const char* path) {
     if(path_len == 0) c11__abort("module path cannot be empty");
 
     py_ModuleInfo* mi = py_newobject(py_retval(), tp_module, -1, sizeof(py_ModuleInfo));
+    mi->dict_version = 1;
 
     int last_dot = c11_sv__rindex((c11_sv){path, path_len}, '.');
     if(last_dot == -1) {
@@ -782,14 +783,6 @@ py_GlobalRef pk_builtins__register() {
 void function__gc_mark(void* ud, c11_vector* p_stack) {
     Function* func = ud;
     if(func->globals) pk__mark_value(func->globals);
-    if(func->closure) {
-        NameDict* dict = func->closure;
-        for(int i = 0; i < dict->capacity; i++) {
-            NameDict_KV* kv = &dict->items[i];
-            if(kv->key == NULL) continue;
-            pk__mark_value(&kv->value);
-        }
-    }
     FuncDecl__gc_mark(func->decl, p_stack);
 }
 
@@ -76,6 +76,7 @@ static uint64_t Dict__hash_2nd(uint64_t key) {
 static void Dict__ctor(Dict* self, uint32_t capacity, int entries_capacity) {
     self->length = 0;
     self->capacity = capacity;
+    self->version = 0;
 
     size_t indices_size;
     if(self->capacity < UINT16_MAX) {
@@ -195,6 +196,7 @@ static void Dict__clear(Dict* self) {
     memset(self->indices, -1, indices_size);
     c11_vector__clear(&self->entries);
     self->length = 0;
+    self->version++;
 }
 
 static void Dict__rehash_2x(Dict* self) {
@@ -203,6 +205,7 @@ static void Dict__rehash_2x(Dict* self) {
     uint32_t mask = new_capacity - 1;
     // create a new dict with new capacity
     Dict__ctor(self, new_capacity, old_dict.entries.capacity);
+    self->version = old_dict.version;
     // move entries from old dict to new dict
     for(int i = 0; i < old_dict.entries.length; i++) {
         DictEntry* old_entry = c11__at(DictEntry, &old_dict.entries, i);
@@ -264,6 +267,7 @@ static bool Dict__set(Dict* self, py_TValue* key, py_TValue* val) {
     new_entry->val = *val;
     Dict__set_index(self, idx, self->entries.length - 1);
     self->length++;
+    self->version++;
     // check if we need to rehash
     float load_factor = (float)self->length / self->capacity;
     if(load_factor > (self->index_is_short ? 0.3f : 0.4f)) Dict__rehash_2x(self);
@@ -286,6 +290,7 @@ static int Dict__pop(Dict* self, py_Ref key) {
     py_newnil(&entry->key);
     py_newnil(&entry->val);
     self->length--;
+    self->version++;
 
     /* tidy */
     // https://github.com/OpenHFT/Chronicle-Map/blob/820573a68471509ffc1b0584454f4a67c0be1b84/src/main/java/net/openhft/chronicle/hash/impl/CompactOffHeapLinearHashTable.java#L156
@@ -382,6 +387,7 @@ static bool dict__init__(int argc, py_Ref argv) {
         py_Ref key = py_tuple_getitem(tuple, 0);
         py_Ref val = py_tuple_getitem(tuple, 1);
         if(!Dict__set(self, key, val)) return false;
+        pk__write_barrier(argv->_obj);
     }
     py_newnone(py_retval());
     return true;
@@ -406,8 +412,10 @@ static bool dict__setitem__(int argc, py_Ref argv) {
     PY_CHECK_ARGC(3);
     Dict* self = py_touserdata(argv);
     bool ok = Dict__set(self, py_arg(1), py_arg(2));
-    if(ok) py_newnone(py_retval());
-    return ok;
+    if(!ok) return false;
+    pk__write_barrier(argv->_obj);
+    py_newnone(py_retval());
+    return true;
 }
 
 static bool dict__delitem__(int argc, py_Ref argv) {
@@ -524,6 +532,7 @@ static bool dict_copy(int argc, py_Ref argv) {
     new_dict->length = self->length;
     new_dict->capacity = self->capacity;
     new_dict->null_index_value = self->null_index_value;
+    new_dict->version = 0;
     new_dict->index_is_short = self->index_is_short;
     // copy entries
     new_dict->entries = c11_vector__copy(&self->entries);
@@ -544,6 +553,7 @@ static bool dict_update(int argc, py_Ref argv) {
         DictEntry* entry = c11__at(DictEntry, &other->entries, i);
         if(py_isnil(&entry->key)) continue;
         if(!Dict__set(self, &entry->key, &entry->val)) return false;
+        pk__write_barrier(argv->_obj);
     }
     py_newnone(py_retval());
     return true;
@@ -675,7 +685,9 @@ int py_dict_getitem(py_Ref self, py_Ref key) {
 bool py_dict_setitem(py_Ref self, py_Ref key, py_Ref val) {
     assert(py_isdict(self));
     Dict* ud = py_touserdata(self);
-    return Dict__set(ud, key, val);
+    if(!Dict__set(ud, key, val)) return false;
+    pk__write_barrier(self->_obj);
+    return true;
 }
 
 int py_dict_delitem(py_Ref self, py_Ref key) {
@@ -6,20 +6,13 @@
 #include "pocketpy/common/sstream.h"
 #include "pocketpy/objects/exception.h"
 
-void py_BaseException__stpush(py_Frame* frame,
-                              py_Ref self,
-                              SourceData_ src,
-                              int lineno,
-                              const char* func_name) {
+static BaseExceptionFrame* BaseException__emplace_frame(py_Ref self, py_Frame* frame) {
     BaseException* ud = py_touserdata(self);
     int max_frame_dumps = py_debugger_isattached() ? 31 : 7;
-    if(ud->stacktrace.length >= max_frame_dumps) return;
+    if(ud->stacktrace.length >= max_frame_dumps) return NULL;
     BaseExceptionFrame* frame_dump = c11_vector__emplace(&ud->stacktrace);
-    PK_INCREF(src);
-    frame_dump->src = src;
-    frame_dump->lineno = lineno;
-    frame_dump->name = func_name ? c11_string__new(func_name) : NULL;
-
+    frame_dump->decl = NULL;
+    frame_dump->ip = -1;
     if(py_debugger_isattached()) {
         if(frame != NULL) {
             py_Frame_newlocals(frame, &frame_dump->locals);
@@ -28,14 +21,55 @@ void py_BaseException__stpush(py_Frame* frame,
             py_newdict(&frame_dump->locals);
             py_newdict(&frame_dump->globals);
         }
+        pk__write_barrier(self->_obj);
+    } else {
+        py_newnil(&frame_dump->locals);
+        py_newnil(&frame_dump->globals);
+    }
+    return frame_dump;
+}
+
+void py_BaseException__stpush(py_Frame* frame, py_Ref self) {
+    BaseExceptionFrame* frame_dump = BaseException__emplace_frame(self, frame);
+    if(!frame_dump) return;
+    frame_dump->src = frame->co->src;
+    PK_INCREF(frame_dump->src);
+    if(frame->is_locals_special) {
+        // module or class bodies may release their code before the traceback is printed
+        frame_dump->lineno = Frame__lineno(frame);
+    } else {
+        // a function frame runs the code of a `FuncDecl`, keep it alive instead
+        frame_dump->lineno = -1;
+        frame_dump->decl = (FuncDecl*)((char*)frame->co - offsetof(FuncDecl, code));
+        frame_dump->ip = frame->ip;
+        PK_INCREF(frame_dump->decl);
     }
 }
 
+void py_BaseException__stpush_source(py_Ref self, SourceData_ src, int lineno) {
+    BaseExceptionFrame* frame_dump = BaseException__emplace_frame(self, NULL);
+    if(!frame_dump) return;
+    frame_dump->src = src;
+    frame_dump->lineno = lineno;
+    PK_INCREF(src);
+}
+
+int BaseExceptionFrame__lineno(const BaseExceptionFrame* self) {
+    if(self->lineno >= 0) return self->lineno;
+    const CodeObject* co = &self->decl->code;
+    if(self->ip < 0) return co->start_line;
+    return c11__at(BytecodeEx, &co->codes_ex, self->ip)->lineno;
+}
+
+const char* BaseExceptionFrame__name(const BaseExceptionFrame* self) {
+    return self->decl ? self->decl->code.name->data : NULL;
+}
+
 static void BaseException__dtor(void* ud) {
     BaseException* self = (BaseException*)ud;
     c11__foreach(BaseExceptionFrame, &self->stacktrace, it) {
         PK_DECREF(it->src);
-        if(it->name) c11_string__delete(it->name);
+        if(it->decl) PK_DECREF(it->decl);
     }
     c11_vector__dtor(&self->stacktrace);
 }
@@ -55,6 +89,7 @@ static bool _py_BaseException__init__(int argc, py_Ref argv) {
     if(argc == 1 + 0) return true;
     if(argc == 1 + 1) {
         py_assign(&ud->args, &argv[1]);
+        pk__write_barrier(argv->_obj);
         return true;
     }
     return TypeError("__init__() takes at most 1 arguments but %d were given", argc - 1);
@@ -180,9 +215,9 @@ static void c11_sbuf__write_exc(c11_sbuf* self, py_Ref exc) {
         BaseExceptionFrame* frame = c11__at(BaseExceptionFrame, &ud->stacktrace, i);
         SourceData__snapshot(frame->src,
                              self,
-                             frame->lineno,
+                             BaseExceptionFrame__lineno(frame),
                              NULL,
-                             frame->name ? frame->name->data : NULL);
+                             BaseExceptionFrame__name(frame));
         c11_sbuf__write_char(self, '\n');
     }
 
@@ -119,6 +119,35 @@ int py_next(py_Ref val) {
     return -1;
 }
 
+static bool pk__bindclsvar(py_Ref self, py_TypeInfo* ti, py_Name name, py_Ref cls_var) {
+    // bound method is non-data descriptor
+    switch(cls_var->type) {
+        case tp_function: {
+            if(name == __new__) goto __STATIC_NEW;
+            py_newboundmethod(py_retval(), self, cls_var);
+            return true;
+        }
+        case tp_nativefunc: {
+            if(name == __new__) goto __STATIC_NEW;
+            py_newboundmethod(py_retval(), self, cls_var);
+            return true;
+        }
+        case tp_staticmethod: {
+            py_assign(py_retval(), py_getslot(cls_var, 0));
+            return true;
+        }
+        case tp_classmethod: {
+            py_newboundmethod(py_retval(), &ti->self, py_getslot(cls_var, 0));
+            return true;
+        }
+        default: {
+        __STATIC_NEW:
+            py_assign(py_retval(), cls_var);
+            return true;
+        }
+    }
+}
+
 bool py_getattr(py_Ref self, py_Name name) {
     // https://docs.python.org/3/howto/descriptor.html#invocation-from-an-instance
     py_TypeInfo* ti = pk_typeinfo(self->type);
@@ -158,34 +187,7 @@ bool py_getattr(py_Ref self, py_Name name) {
         }
     }
 
-    if(cls_var) {
-        // bound method is non-data descriptor
-        switch(cls_var->type) {
-            case tp_function: {
-                if(name == __new__) goto __STATIC_NEW;
-                py_newboundmethod(py_retval(), self, cls_var);
-                return true;
-            }
-            case tp_nativefunc: {
-                if(name == __new__) goto __STATIC_NEW;
-                py_newboundmethod(py_retval(), self, cls_var);
-                return true;
-            }
-            case tp_staticmethod: {
-                py_assign(py_retval(), py_getslot(cls_var, 0));
-                return true;
-            }
-            case tp_classmethod: {
-                py_newboundmethod(py_retval(), &ti->self, py_getslot(cls_var, 0));
-                return true;
-            }
-            default: {
-            __STATIC_NEW:
-                py_assign(py_retval(), cls_var);
-                return true;
-            }
-        }
-    }
+    if(cls_var) return pk__bindclsvar(self, ti, name, cls_var);
 
     py_Ref fallback = pk_tpfindmagic(ti, __getattr__);
     if(fallback) {
@@ -242,6 +244,119 @@ bool py_setattr(py_Ref self, py_Name name, py_Ref val) {
     return TypeError("cannot set attribute");
 }
 
+static NameDict* pk__instancedict(py_Ref self) {
+    if(!self->is_ptr || self->_obj->slots != -1) return NULL;
+    return PyObject__dict(self->_obj);
+}
+
+static bool AttrCache__hit(AttrCache* self, py_Type type, py_TypeInfo* ti) {
+    return self->type == type && self->version == ti->version && self->version != 0;
+}
+
+static NameDict_KV* AttrCache__instance_kv(AttrCache* self, NameDict* dict, py_Name name) {
+    if(dict == NULL || self->hint >= dict->capacity) return NULL;
+    NameDict_KV* kv = &dict->items[self->hint];
+    return kv->key == name ? kv : NULL;
+}
+
+// re-resolve `name` on `self` and record how it was found
+static void AttrCache__fill(AttrCache* self, py_Ref obj, py_Name name, bool is_store) {
+    py_TypeInfo* ti = pk_typeinfo(obj->type);
+    self->type = 0;
+    self->kind = AttrCacheKind_EMPTY;
+    // hooked types and type objects take the generic path
+    if(obj->type == tp_type) return;
+    if(is_store ? ti->setattribute != NULL : ti->getattribute != NULL) return;
+
+    py_ItemRef cls_var = pk_tpfindname(ti, name);
+    NameDict* dict = pk__instancedict(obj);
+    int hint = dict ? NameDict__index(dict, name) : -1;
+    if(cls_var && py_istype(cls_var, tp_property)) {
+        self->kind = AttrCacheKind_PROPERTY;
+    } else if(hint >= 0) {
+        self->kind = AttrCacheKind_INSTANCE;
+        self->hint = hint;
+    } else if(cls_var && !is_store && name != __new__) {
+        self->kind = AttrCacheKind_CLASS;
+    } else {
+        return;
+    }
+    uint32_t version = pk_tpversion(ti);
+    if(version == 0) {
+        self->kind = AttrCacheKind_EMPTY;
+        return;
+    }
+    self->type = obj->type;
+    self->version = version;
+    self->cls_var = cls_var;
+}
+
+bool pk_getattr_cached(py_Ref self, py_Name name, AttrCache* cache) {
+    py_TypeInfo* ti = pk_typeinfo(self->type);
+    if(AttrCache__hit(cache, self->type, ti)) {
+        switch(cache->kind) {
+            case AttrCacheKind_INSTANCE: {
+                NameDict_KV* kv = AttrCache__instance_kv(cache, pk__instancedict(self), name);
+                if(kv) {
+                    py_assign(py_retval(), &kv->value);
+                    return true;
+                }
+                break;
+            }
+            case AttrCacheKind_CLASS: {
+                // the instance dict may shadow the class attribute
+                NameDict* dict = pk__instancedict(self);
+                if(dict && dict->length > 0 && NameDict__contains(dict, name)) break;
+                return pk__bindclsvar(self, ti, name, cache->cls_var);
+            }
+            case AttrCacheKind_PROPERTY: {
+                py_Ref getter = py_getslot(cache->cls_var, 0);
+                return py_call(getter, 1, self);
+            }
+            default: break;
+        }
+    }
+    py_TValue obj = *self;  // `self` may be overwritten by the call
+    bool ok = py_getattr(self, name);
+    if(ok) AttrCache__fill(cache, &obj, name, false);
+    return ok;
+}
+
+bool pk_setattr_cached(py_Ref self, py_Name name, py_Ref val, AttrCache* cache) {
+    py_TypeInfo* ti = pk_typeinfo(self->type);
+    if(AttrCache__hit(cache, self->type, ti)) {
+        switch(cache->kind) {
+            case AttrCacheKind_INSTANCE: {
+                NameDict* dict = pk__instancedict(self);
+                if(dict == NULL) break;
+                NameDict_KV* kv = AttrCache__instance_kv(cache, dict, name);
+                if(kv) {
+                    kv->value = *val;
+                    pk__write_barrier(self->_obj);
+                } else {
+                    // the class still has no data descriptor for `name`
+                    // py_setdict() also bumps the dict version of modules
+                    py_setdict(self, name, val);
+                }
+                return true;
+            }
+            case AttrCacheKind_PROPERTY: {
+                py_Ref setter = py_getslot(cache->cls_var, 1);
+                if(py_isnone(setter)) break;
+                py_push(setter);
+                py_push(self);
+                py_push(val);
+                return py_vectorcall(1, 0);
+            }
+            default: break;
+        }
+    }
+    py_TValue obj = *self;
+    bool ok = py_setattr(self, name, val);
+    if(ok) AttrCache__fill(cache, &obj, name, true);
+    return ok;
+}
+
 bool py_delattr(py_Ref self, py_Name name) {
     py_TypeInfo* ti = pk_typeinfo(self->type);
     if(ti->delattribute) return ti->delattribute(self, name);
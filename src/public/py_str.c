@@ -9,7 +9,8 @@
 void py_newstr(py_OutRef out, const char* data) { py_newstrv(out, (c11_sv){data, strlen(data)}); }
 
 char* py_newstrn(py_OutRef out, int size) {
-    if(size < 16) {
+    // short strings are stored inline, the size takes `extra` and the data takes the payload
+    if(size < PK_TVALUE_PAYLOAD_SIZE) {
         out->type = tp_str;
         out->is_ptr = false;
         c11_string* ud = (c11_string*)(&out->extra);
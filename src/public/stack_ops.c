@@ -15,7 +15,17 @@ PK_INLINE py_Ref py_getdict(py_Ref self, py_Name name) {
 
 PK_INLINE void py_setdict(py_Ref self, py_Name name, py_Ref val) {
     assert(self && self->is_ptr);
-    NameDict__set(PyObject__dict(self->_obj), name, val);
+    NameDict* dict = PyObject__dict(self->_obj);
+    pk__write_barrier(self->_obj);
+    if(self->type == tp_module) {
+        // only a new key may move existing items
+        int length = dict->length;
+        NameDict__set(dict, name, val);
+        if(dict->length != length) ((py_ModuleInfo*)py_touserdata(self))->dict_version++;
+        return;
+    }
+    if(self->type == tp_type) pk_tpmodified(py_touserdata(self));
+    NameDict__set(dict, name, val);
 }
 
 py_ItemRef py_emplacedict(py_Ref self, py_Name name) {
@@ -37,12 +47,16 @@ bool py_applydict(py_Ref self, bool (*f)(py_Name, py_Ref, void*), void* ctx) {
 
 void py_cleardict(py_Ref self) {
     assert(self && self->is_ptr);
+    if(self->type == tp_type) pk_tpmodified(py_touserdata(self));
+    if(self->type == tp_module) ((py_ModuleInfo*)py_touserdata(self))->dict_version++;
     NameDict* dict = PyObject__dict(self->_obj);
     NameDict__clear(dict);
 }
 
 bool py_deldict(py_Ref self, py_Name name) {
     assert(self && self->is_ptr);
+    if(self->type == tp_type) pk_tpmodified(py_touserdata(self));
+    if(self->type == tp_module) ((py_ModuleInfo*)py_touserdata(self))->dict_version++;
     return NameDict__del(PyObject__dict(self->_obj), name);
 }
 
@@ -56,6 +70,7 @@ void py_setslot(py_Ref self, int i, py_Ref val) {
     assert(self && self->is_ptr);
     assert(i >= 0 && i < self->_obj->slots);
     PyObject__slots(self->_obj)[i] = *val;
+    pk__write_barrier(self->_obj);
 }
 
 py_StackRef py_inspect_currentfunction() {
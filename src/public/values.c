@@ -16,7 +16,7 @@ void py_newint(py_OutRef out, py_i64 val) {
 void py_newtrivial(py_OutRef out, py_Type type, void* data, int size) {
     out->type = type;
     out->is_ptr = false;
-    assert(size <= 16);
+    assert(size <= PK_TVALUE_PAYLOAD_SIZE);
     memcpy(&out->_chars, data, size);
 }
 
@@ -871,4 +871,22 @@ assert 9 // 7 == 1
 assert 9 % 8 == 1
 assert 9 // 8 == 1
 assert 9 % 9 == 0
-assert 9 // 9 == 1
\ No newline at end of file
+assert 9 // 9 == 1
+# quickened int ops must keep python semantics and deoptimize on other types
+def _int_ops(a, b):
+    return (a + b, a - b, a * b, a // b, a % b, a < b, a <= b, a == b, a != b, a > b, a >= b)
+
+for _ in range(3):
+    assert _int_ops(-7, 3) == (-4, -10, -21, -3, 2, True, True, False, True, False, False)
+    assert _int_ops(7, -3) == (4, 10, -21, -3, -2, False, False, False, True, True, True)
+assert _int_ops(-7, -3) == (-10, -4, 21, 2, -1, True, True, False, True, False, False)
+
+def _int_mod(a, b): return a % b
+
+for _ in range(3): assert _int_mod(5, 3) == 2
+try:
+    _int_mod(5, 0)
+    exit(1)
+except ZeroDivisionError:
+    pass
+assert _int_mod(5.5, 2) == 1.5
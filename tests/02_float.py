@@ -113,4 +113,17 @@ assert abs(0.0) == 0.0
 assert eq(10 % 4, 2)
 assert eq(10.5 % 4, 2.5)
 assert eq(10 % 4.5, 1.0)
-assert eq(10.5 % 4.5, 1.5)
\ No newline at end of file
+assert eq(10.5 % 4.5, 1.5)
+# quickened float ops deoptimize on other types
+def _float_ops(a, b):
+    return (a + b, a - b, a * b, a / b, a < b, a <= b, a == b, a != b, a > b, a >= b)
+
+for _ in range(3):
+    assert _float_ops(2.5, 0.5) == (3.0, 2.0, 1.25, 5.0, False, False, False, True, True, True)
+assert _float_ops(1, 2.0) == (3.0, -1.0, 2.0, 0.5, True, True, False, True, False, False)
+assert _float_ops(3, 4) == (7, -1, 12, 0.75, True, True, False, True, False, False)
+try:
+    _float_ops(1.0, 0.0)
+    exit(1)
+except ZeroDivisionError:
+    pass
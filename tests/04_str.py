@@ -233,5 +233,10 @@ assert f"{(1, 2, 3)}" == "(1, 2, 3)"
 # assert f"{stack[2:]}" == '[3, 4]'
 
 
-assert id('1' * 16) is not None
-assert id('1' * 15) is None
\ No newline at end of file
+from pkpy import configmacros
+if configmacros['PK_ENABLE_COMPACT_TVALUE'] == 1:
+    assert id('1' * 8) is not None
+    assert id('1' * 7) is None
+else:
+    assert id('1' * 16) is not None
+    assert id('1' * 15) is None
\ No newline at end of file
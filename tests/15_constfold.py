@@ -0,0 +1,220 @@
+# constant expressions are folded by the compiler
+# every folded result must match the same operation done at runtime
+one, two, three, zero = 1, 2, 3, 0
+half, neg = 0.5, -7
+
+assert 1 + 2 == one + two == 3
+assert 2 * 3 - 1 == two * three - one == 5
+assert 7 // 2 == 7 // two == 3
+assert -7 // 2 == neg // two == -4
+assert -7 % 3 == neg % three == 2
+assert 7 % -3 == 7 % -three == -2
+assert 1 / 2 == one / two == 0.5
+assert 2 ** 10 == two ** 10 == 1024
+assert 2 ** -1 == two ** -one == 0.5
+assert 2.0 ** 3 == 8.0
+assert 1.5 + 1 == half + 1 + one == 2.5
+assert 1 << 10 == one << 10 == 1024
+assert 1024 >> 3 == 128
+assert 6 & 3 == 2 and 6 | 3 == 7 and 6 ^ 3 == 5
+assert -(1 + 2) == -3
+assert ~5 == ~(two + three) == -6
+assert --5 == 5
+assert -(-0.5) == half
+assert type(1 + 2) is int
+assert type(1 / 1) is float
+assert type(2 ** -1) is float
+
+# comparisons and chains
+assert (1 < 2) is True
+assert (2 <= 1) is False
+assert 1 < 2 < 3
+assert not (1 < 3 < 2)
+assert ((1 < 2) == True) is True
+assert 'a' < 'b'
+assert 'abc' == 'ab' + 'c'
+assert 1 == 1.0
+
+# logical operators keep the operand, not a bool
+assert (0 or 5) == 5
+assert (3 and 0) == 0
+assert (None or 'x') == 'x'
+assert ('' and 1) == ''
+assert (True and 2 + 3) == 5
+
+# not of constants
+assert (not 0) is True
+assert (not 'a') is False
+assert (not None) is True
+assert (not ()) is True
+assert (not (1,)) is False
+
+# strings
+assert 'ab' + 'cd' == 'abcd'
+assert 'ab' * 3 == 'ababab'
+assert 'ab' * 0 == ''
+assert 'ab' * -1 == ''
+s = 'x' * 10000
+assert len(s) == 10000
+s = 'x' * 3000 + 'y' * 3000
+assert len(s) == 6000
+
+# constant tuples
+t = (1, 'a', None, (2.5, True), ...)
+assert t == (1, 'a', None, (2.5, True), ...)
+assert type(t) is tuple and len(t) == 5
+assert t[3][1] is True
+assert t[4] is ...
+assert () == tuple()
+assert (1 + 2, 3 * 4) == (3, 12)
+
+def get_tuple():
+    return (1, 2, 3)
+
+assert get_tuple() == (1, 2, 3)
+a, b, c = 1, 2, 3
+assert (a, b, c) == (1, 2, 3)
+res = []
+for x in (1, 2, 3):
+    res.append(x)
+assert res == [1, 2, 3]
+
+# operations that raise are left for the runtime
+def raises(f, exc):
+    try:
+        f()
+    except exc:
+        return True
+    return False
+
+assert raises(lambda: 1 / 0, ZeroDivisionError)
+assert raises(lambda: 1 // 0, ZeroDivisionError)
+assert raises(lambda: 1 % 0, ZeroDivisionError)
+assert raises(lambda: 1.0 / 0, ZeroDivisionError)
+assert raises(lambda: 0 ** -1, ZeroDivisionError)
+assert raises(lambda: 1 + 'a', TypeError)
+assert raises(lambda: 'a' - 'b', TypeError)
+assert raises(lambda: 1.5 << 1, TypeError)
+assert raises(lambda: -'a', Exception)
+assert raises(lambda: ~1.5, Exception)
+
+# dead branches
+res = []
+if False:
+    res.append(1)
+if 0:
+    res.append(2)
+elif 1:
+    res.append(3)
+else:
+    res.append(4)
+if True:
+    res.append(5)
+else:
+    res.append(6)
+if not True:
+    res.append(7)
+elif 2 > 1:
+    res.append(8)
+while False:
+    res.append(9)
+else:
+    res.append(10)
+assert res == [3, 5, 8, 10]
+
+i = 0
+while True:
+    i += 1
+    if i == 10:
+        break
+assert i == 10
+
+i = 0
+while 1:
+    i += 1
+    if i < 5:
+        continue
+    break
+assert i == 5
+
+# names assigned in a dead branch are still locals
+def f():
+    if False:
+        x = 1
+    return x
+
+assert raises(f, UnboundLocalError)
+
+# `if False: yield` still makes a generator
+def g():
+    if False:
+        yield 1
+
+assert list(g()) == []
+
+def g2():
+    yield 1
+    if 0:
+        for i in range(3):
+            yield i
+    while False:
+        yield 2
+    yield 3
+
+assert list(g2()) == [1, 3]
+
+# exception handlers in dead code are dropped with it
+def h():
+    if False:
+        try:
+            pass
+        except ValueError:
+            return 'dead'
+    try:
+        raise ValueError
+    except ValueError:
+        return 'live'
+
+assert h() == 'live'
+
+# loops and nested functions inside dead branches
+def k():
+    if False:
+        for i in range(10):
+            if i: break
+            else: continue
+        def inner():
+            return 1
+        with open('x') as fp:
+            pass
+    for i in range(3):
+        if i == 1:
+            break
+    return i
+
+assert k() == 1
+
+# syntax errors in dead code are still reported
+try:
+    exec('if False:\n    1 +\n')
+    exit(1)
+except SyntaxError:
+    pass
+
+# `//` is not defined for floats, the error is raised at runtime
+for src in ['7.5 // 2', '1 // 2.0', '1.0 // 1.0']:
+    try:
+        eval(src)
+        exit(1)
+    except TypeError:
+        pass
+assert 7 // 2 == 3
+
+def floordiv_float():
+    return 1.0 // 1.0
+
+try:
+    floordiv_float()
+    exit(1)
+except TypeError:
+    pass
@@ -185,3 +185,87 @@ assert f(1, 2) == 3
 #         pass
     
 # assert A().f(1, 2, 3) == None
+
+# fused opcode sequences must behave like the unfused ones
+def _cmp_jump(a, b):
+    x = a
+    y = x
+    if a == b: return 'eq'
+    if a != b and a >= b: return 'ge'
+    return y - 1
+
+assert _cmp_jump(1, 1) == 'eq' and _cmp_jump(2, 1) == 'ge' and _cmp_jump(1, 2) == 0
+assert _cmp_jump(1.5, 1.5) == 'eq' and _cmp_jump('b', 'a') == 'ge'
+
+def _add_sub_one(a):
+    return a + 1, a - 1
+
+class _AddSub:
+    def __add__(self, o): return 'added'
+    def __sub__(self, o): return 'subbed'
+
+assert _add_sub_one(1) == (2, 0) and _add_sub_one(1.5) == (2.5, 0.5)
+assert _add_sub_one(_AddSub()) == ('added', 'subbed')
+
+def _unbound_second():
+    a, b = 1, 2
+    del b
+    try:
+        return a + b
+    except UnboundLocalError:
+        return 'unbound'
+
+assert _unbound_second() == 'unbound'
+
+# a call site with keywords caches the layout of the last callee
+def kw_a(x=0, y=0, z=0):
+    return ('a', x, y, z)
+
+def kw_b(z=1, y=2, **kw):
+    return ('b', z, y, kw)
+
+def kw_c(**kw):
+    return ('c', kw)
+
+class KwInit:
+    def __init__(self, a=1, y=2, z=3):
+        self.v = (a, y, z)
+
+res = []
+for f in [kw_a, kw_a, kw_b, kw_b, kw_a, kw_c, kw_c, kw_b]:
+    res.append(f(y=5, z=6))
+assert res == [
+    ('a', 0, 5, 6), ('a', 0, 5, 6),
+    ('b', 6, 5, {}), ('b', 6, 5, {}),
+    ('a', 0, 5, 6),
+    ('c', {'y': 5, 'z': 6}), ('c', {'y': 5, 'z': 6}),
+    ('b', 6, 5, {}),
+]
+
+for _ in range(3):
+    assert KwInit(y=7, z=8).v == (1, 7, 8)
+
+def kw_d(x=0, y=0):
+    return x + y
+
+for f in [kw_d, kw_d, kw_b]:
+    try:
+        res = f(y=1, w=2)
+        assert f is kw_b and res == ('b', 1, 1, {'w': 2})
+    except TypeError:
+        assert f is kw_d
+
+# a failed lookup must not leave a half-written layout behind
+def kw_e(y=0, w=0):
+    return (y, w)
+
+def kw_f(q=0, y=0):
+    return (q, y)
+
+res = []
+for f in [kw_e, kw_f, kw_e]:
+    try:
+        res.append(f(y=1, w=2))
+    except TypeError:
+        assert f is kw_f
+assert res == [(1, 2), (1, 2)]
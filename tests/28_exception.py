@@ -238,3 +238,54 @@ try:
 except IndexError:
     g()
 
+
+# handlers restore the values kept on the stack by enclosing for/with blocks
+class _CM:
+    def __enter__(self): return self
+    def __exit__(self, *args): pass
+
+def _nested_handlers():
+    for i in range(3):
+        with _CM():
+            for j in [1, 2]:
+                try:
+                    yield i, j
+                    raise KeyError(i)
+                except KeyError:
+                    pass
+                finally:
+                    pass
+
+assert list(_nested_handlers()) == [(0, 1), (0, 2), (1, 1), (1, 2), (2, 1), (2, 2)]
+
+class _HandlerInClassBody:
+    for i in range(2):
+        try:
+            raise ValueError
+        except ValueError:
+            caught = i
+
+assert _HandlerInClassBody.caught == 1
+
+def _reraise_in_handler():
+    n = 0
+    for _ in range(3):
+        try:
+            try:
+                [1 / 0 for _ in range(3)]
+            except ZeroDivisionError:
+                raise TypeError
+        except TypeError:
+            n += 1
+    return n
+
+assert _reraise_in_handler() == 3
+
+class _Attr: pass
+_obj = _Attr()
+_obj.x = 1
+del _obj.x
+try:
+    raise IndexError
+except IndexError:
+    pass
@@ -50,3 +50,74 @@ try:
 except StopIteration:
     pass
 
+
+# `for` loops over builtin containers run without iterator objects
+def collect(x):
+    return [v for v in x]
+
+assert collect(range(5)) == [0, 1, 2, 3, 4]
+assert collect(range(5, 0, -2)) == [5, 3, 1]
+assert collect(range(0)) == []
+assert collect(range(0, 2**40, 2**35)) == [i * 2**35 for i in range(32)]
+assert collect(range(2**31 - 5, 2**31 - 1, 3)) == [2**31 - 5, 2**31 - 2]
+assert collect(range(-2**31 + 4, -2**31, -3)) == [-2**31 + 4, -2**31 + 1]
+assert collect(range(2**31 - 2, 2**31 + 1)) == [2**31 - 2, 2**31 - 1, 2**31]
+assert collect((1, 'a', None)) == [1, 'a', None]
+assert collect('abc') == ['a', 'b', 'c']
+assert collect('你好, this string is stored on the heap') == list('你好, this string is stored on the heap')
+assert collect({1: 2, 3: 4}) == [1, 3]
+
+# the same loop head sees different container types
+assert [collect(x) for x in [[1], (2,), 'c', range(1), {5: 6}, iter([7])]] == [[1], [2], ['c'], [0], [5], [7]]
+
+def gen(x):
+    for v in x:
+        yield v
+
+g1 = gen([1, 2, 3])
+g2 = gen(range(10, 13))
+assert next(g1) == 1
+assert next(g2) == 10
+assert next(g1) == 2
+assert next(g2) == 11
+assert list(g1) == [3]
+assert list(g2) == [12]
+
+# a list grown inside the loop is iterated to its new end
+a = [1, 2, 3]
+res = []
+for x in a:
+    if x < 3:
+        a.append(x + 10)
+    res.append(x)
+assert res == [1, 2, 3, 11, 12]
+
+d = {1: 1, 2: 2}
+try:
+    for k in d:
+        d[k + 10] = 0
+    exit(1)
+except RuntimeError:
+    pass
+
+# a deletion followed by an insertion keeps the length unchanged
+d = {0: 0}
+try:
+    for k in d:
+        del d[k]
+        d[k + 1] = 0
+    exit(1)
+except RuntimeError:
+    pass
+
+d = {1: 1, 2: 2, 3: 3}
+for k in d:
+    d[k] = k * 2
+assert d == {1: 2, 2: 4, 3: 6}
+
+total = 0
+for i in range(100):
+    if i == 10:
+        break
+    total += i
+assert total == 45
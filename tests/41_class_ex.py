@@ -167,4 +167,56 @@ class DerivedClass(BaseClass):
         return super().f()
 
     
-assert DerivedClass.f() == 'BaseClass'
\ No newline at end of file
+assert DerivedClass.f() == 'BaseClass'
+# test attribute caches are invalidated when classes change
+class CacheA:
+    x = 5
+    def f(self): return 1
+    @property
+    def p(self): return 10
+
+class CacheB(CacheA): pass
+
+def _call_f(o): return o.f()
+def _get_x(o): return o.x
+def _set_x(o, v): o.x = v
+def _get_p(o): return o.p
+
+b = CacheB()
+for _ in range(3): assert _call_f(b) == 1
+CacheA.f = lambda self: 2
+assert _call_f(b) == 2
+
+for _ in range(3): assert _get_x(b) == 5
+b.x = 7
+assert _get_x(b) == 7
+del b.x
+assert _get_x(b) == 5
+CacheB.x = 9
+assert _get_x(b) == 9
+assert _get_x(CacheA()) == 5
+
+for i in range(3): _set_x(b, i)
+assert b.x == 2
+
+for _ in range(3): assert _get_p(b) == 10
+CacheA.p = property(lambda self: 11)
+assert _get_p(b) == 11
+
+# test magic method slots are invalidated when classes change
+class MagicA:
+    def __add__(self, o): return 1
+    def __len__(self): return 3
+
+class MagicB(MagicA): pass
+
+b = MagicB()
+assert b + 1 == 1 and len(b) == 3
+MagicA.__add__ = lambda self, o: 2
+assert b + 1 == 2
+MagicB.__len__ = lambda self: 4
+assert len(b) == 4 and len(MagicA()) == 3
+del MagicB.__len__
+assert len(b) == 3
+MagicB.__getitem__ = lambda self, i: i * 2
+assert b[5] == 10
@@ -1,4 +1,4 @@
-# only one level nested closure is implemented
+# closures capture the enclosing variables they use by value, at creation time
 
 def f0(a, b):
     def f1():
@@ -61,3 +61,56 @@ try:
     assert False
 except StopIteration as e:
     assert e.value == 3
+
+# closures capture the values of the enclosing locals at creation time
+def make_adders():
+    res = []
+    for i in range(3):
+        res.append(lambda x: x + i)
+    return res
+
+assert [f(10) for f in make_adders()] == [10, 11, 12]
+
+# a local bound after the closure is created falls back to globals
+late = 'global'
+def f():
+    def g():
+        return late
+    late = 'local'
+    return g
+
+assert f()() == 'global'
+
+# a decorator capturing its arguments
+def repeat(n):
+    def deco(fn):
+        def wrapper(*args):
+            return [fn(*args) for _ in range(n)]
+        return wrapper
+    return deco
+
+@repeat(3)
+def hello(name):
+    return 'hi ' + name
+
+assert hello('a') == ['hi a', 'hi a', 'hi a']
+
+# recursion through the captured name of the function itself
+def outer():
+    def fib(n):
+        return n if n < 2 else fib(n - 1) + fib(n - 2)
+    return fib
+
+assert outer()(10) == 55
+
+# variables are forwarded through every enclosing function
+def l1(a):
+    def l2(b):
+        def l3(c):
+            def l4():
+                return (a, b, c, len([l1, l2, l3]))
+            return l4
+        return l3
+    return l2
+
+assert l1(1)(2)(3)() == (1, 2, 3, 3)
@@ -127,4 +127,43 @@ def f():
     a = yield from g()
     yield a
 
-assert list(f()) == [1, 2, 3]
\ No newline at end of file
+assert list(f()) == [1, 2, 3]
+# generators driven by for-loops and `yield from` end without StopIteration
+def deep(n):
+    x = [i for i in range(n)]
+    for i in range(n):
+        yield x[i] + i
+
+total = 0
+for _ in range(100):
+    for v in deep(20):
+        total += v
+assert total == 100 * 380
+
+def nested(k):
+    if k == 0:
+        return 'done'
+    r = yield from nested(k - 1)
+    yield k
+    return r
+
+g = nested(5)
+assert list(g) == [1, 2, 3, 4, 5]
+assert list(g) == []
+
+def chained():
+    r = yield from nested(3)
+    yield r
+
+assert list(chained()) == [1, 2, 3, 'done']
+
+def raises():
+    yield 1
+    raise ValueError('boom')
+
+try:
+    for _ in raises():
+        pass
+    exit(1)
+except ValueError as e:
+    assert str(e) == 'boom'
@@ -38,4 +38,57 @@ def main():
 main()
 """, globals())
 
-assert "sys" in globals()
\ No newline at end of file
+assert "sys" in globals()
+
+# LOAD_GLOBAL caches must see globals that shadow builtins, deletions and rehashes
+def get_len():
+    return len
+
+for _ in range(3):
+    assert get_len() is len
+
+def len(x):
+    return -1
+
+for _ in range(3):
+    assert get_len()('abc') == -1
+
+del len
+for _ in range(3):
+    assert get_len()('abc') == 3
+
+counter = 0
+def read_counter():
+    return counter
+
+for i in range(3):
+    counter = i
+    assert read_counter() == i
+
+# insert enough globals to force the module dict to rehash
+for i in range(100):
+    globals()[f'_g{i}'] = i
+assert read_counter() == 2
+counter = 10
+assert read_counter() == 10
+
+del counter
+try:
+    read_counter()
+    exit(1)
+except NameError:
+    pass
+
+import builtins
+builtins.my_builtin = 1
+def read_builtin():
+    return my_builtin
+assert read_builtin() == 1
+builtins.my_builtin = 2
+assert read_builtin() == 2
+del builtins.my_builtin
+try:
+    read_builtin()
+    exit(1)
+except NameError:
+    pass
@@ -9,4 +9,189 @@ gc.collect()
 
 create_garbage()
 create_garbage()
-create_garbage()
\ No newline at end of file
+create_garbage()
+
+# young collections
+gc.disable()
+gc.collect()
+a = [[i] for i in range(10000)]
+del a
+assert gc.collect(0) >= 10000
+assert gc.collect(0) == 0
+assert gc.collect(generation=0) == 0
+assert gc.collect(generation=2) == 0
+gc.enable()
+
+# young objects stored into old objects must survive a young collection
+class Node:
+    def __init__(self, value):
+        self.value = value
+
+old_slots = [None] * 10
+old_list = []
+old_dict = {}
+old_node = Node(None)
+def old_gen():
+    yield 0
+    x = [0]
+    yield 1
+    yield x
+old_iter = old_gen()
+next(old_iter)
+gc.collect()
+
+def store_young(i):
+    old_slots[i % 10] = [i]
+    old_list.append(Node(i))
+    old_list.insert(0, str(i) + '!')
+    old_dict[i] = [i, i]
+    old_node.value = Node(i)
+    setattr(old_node, 'attr_' + str(i % 10), [i])
+
+for i in range(100):
+    store_young(i)
+    if i == 50:
+        next(old_iter)
+    gc.collect(0)
+    garbage = [[j] for j in range(100)]
+
+for i in range(10):
+    assert old_slots[i] == [90 + i]
+    assert getattr(old_node, 'attr_' + str(i)) == [90 + i]
+assert old_list[:100] == [str(i) + '!' for i in range(99, -1, -1)]
+assert [n.value for n in old_list[100:]] == list(range(100))
+assert old_dict == {i: [i, i] for i in range(100)}
+assert old_node.value.value == 99
+assert next(old_iter) == [0]
+gc.collect()
+assert old_dict[42] == [42, 42]
+
+# incremental collections
+gc.disable()
+gc.collect()
+assert gc.step() is True
+assert gc.step(budget_us=100) is True
+
+def begin_full_collection():
+    # promote enough objects for a full collection to be due
+    promoted = [[i] for i in range(100000)]
+    gc.collect(0)
+    # leave some garbage for non-generational builds
+    promoted = [None]
+    assert gc.step(0) is False
+
+begin_full_collection()
+while not gc.step(0):
+    pass
+
+# objects written while a collection is in progress must survive
+graph = [Node([i]) for i in range(5000)]
+for round in range(3):
+    begin_full_collection()
+    for i in range(5000):
+        graph[i].value = [i, round]
+        if i % 100 == 0:
+            graph.append(Node(str(i)))
+            gc.step(0)
+    while not gc.step(100):
+        pass
+    for i in range(5000):
+        assert graph[i].value == [i, round]
+assert len(graph) == 5150
+assert graph[-1].value == '4900'
+
+# a full collection finishes the one in progress
+begin_full_collection()
+assert gc.collect() >= 0
+assert gc.step(0) is True
+gc.enable()
+
+# young arenas are swept lazily, before allocating from them again
+class Small:
+    pass
+
+kept = []
+for i in range(20):
+    batch = [(i, j) for j in range(2000)] + [Small() for _ in range(500)]
+    kept.append(batch[i])
+    kept.append(batch[-1])
+    gc.collect(0)
+gc.collect()
+for i in range(20):
+    assert kept[2 * i] == (i, i)
+    assert type(kept[2 * i + 1]) is Small
+
+# frozen objects are neither traversed nor freed
+class Leaf:
+    def __init__(self, i):
+        self.items = [i, str(i)]
+
+startup = {i: Leaf(i) for i in range(50000)}
+gc.disable()
+
+def full_collection_marked():
+    gc.collect()
+    return gc.get_stats()[-1]['marked']
+
+before = full_collection_marked()
+assert before >= 100000
+gc.freeze()
+assert gc.get_freeze_count() >= 100000
+after = full_collection_marked()
+assert after < before - 100000, (before, after)
+
+# new objects stored into frozen ones survive
+frozen_leaf = startup[7]
+frozen_leaf.items.append([7, 7])
+frozen_leaf.extra = Leaf(-7)
+startup[-1] = Leaf(-1)
+for i in range(3):
+    garbage = [Leaf(j) for j in range(1000)]
+    gc.collect(0)
+    gc.collect()
+while not gc.step(0):
+    pass
+assert startup[7].items == [7, '7', [7, 7]]
+assert startup[7].extra.items == [-7, '-7']
+assert startup[-1].items == [-1, '-1']
+assert startup[49999].items == [49999, '49999']
+
+gc.unfreeze()
+assert gc.get_freeze_count() == 0
+del startup
+assert gc.collect() >= 100000
+gc.enable()
+
+# per-collection statistics and callbacks
+events = []
+def on_gc(phase, info):
+    events.append((phase, info['generation'], info['freed']))
+    # collections requested from a callback are skipped
+    assert gc.collect() == 0
+
+# no collection in progress, so gc.collect() only reports its own
+gc.disable()
+gc.collect()
+gc.callbacks.append(on_gc)
+garbage = [[i] for i in range(1000)]
+del garbage
+freed = gc.collect()
+gc.callbacks.clear()
+gc.enable()
+assert events[-2] == ('start', 1, 0)
+assert events[-1] == ('stop', 1, freed)
+
+stats = gc.get_stats()
+assert 1 <= len(stats) <= 32
+last = stats[-1]
+assert last['generation'] == 1 and last['incremental'] is False
+assert last['freed'] == freed
+assert last['freed'] == last['freed_large'] + sum(last['freed_pools'].values())
+assert last['mark_ns'] >= 0 and last['sweep_ns'] >= 0 and last['marked'] >= 0
+assert last['threshold'] > 0
+
+for i in range(50):
+    gc.collect(0)
+stats = gc.get_stats()
+assert len(stats) == 32
+assert stats[-1]['start_ns'] >= last['start_ns']
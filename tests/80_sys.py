@@ -2,3 +2,35 @@ import sys
 
 assert len(sys.argv) == 2
 assert (sys.argv[1] == 'tests/80_sys.py'), sys.argv
+
+# call chains deeper than the preallocated frame stack spill to the heap
+import pkpy
+old_limit = sys.getrecursionlimit()
+frame_stack_size = pkpy.configmacros['PK_VM_FRAME_STACK_SIZE']
+sys.setrecursionlimit(frame_stack_size * 2)
+
+def depth(n):
+    if n == 0:
+        return 0
+    return depth(n - 1) + 1
+
+for _ in range(3):
+    assert depth(frame_stack_size + 200) == frame_stack_size + 200
+
+def gen_depth(n):
+    if n == 0:
+        yield 0
+        return
+    for v in gen_depth(n - 1):
+        yield v + 1
+
+assert list(gen_depth(300)) == [300]
+
+try:
+    depth(frame_stack_size * 3)
+    exit(1)
+except RecursionError:
+    pass
+assert depth(10) == 10
+
+sys.setrecursionlimit(old_limit)
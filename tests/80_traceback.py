@@ -16,4 +16,48 @@ if actual != expected:
     print(actual)
     print('--- EXPECTED RESULT ---')
     print(expected)
-    exit(1)
\ No newline at end of file
+    exit(1)
+
+# function frames are resolved when the traceback is formatted
+def inner(x):
+    return x[0]
+
+def outer():
+    y = 1
+    return inner(None)
+
+try:
+    outer()
+except TypeError:
+    actual = traceback.format_exc()
+
+expected = '''Traceback (most recent call last):
+  File "tests/80_traceback.py", line 30
+    outer()
+  File "tests/80_traceback.py", line 27, in outer
+    return inner(None)
+  File "tests/80_traceback.py", line 23, in inner
+    return x[0]
+TypeError: 'NoneType' object is not subscriptable'''
+
+if actual != expected:
+    print('--- ACTUAL RESULT -----')
+    print(actual)
+    print('--- EXPECTED RESULT ---')
+    print(expected)
+    exit(1)
+
+# the traceback outlives the function that raised
+g = {}
+exec('def boom():\n    raise ValueError("boom")\n', g)
+try:
+    g['boom']()
+except ValueError:
+    del g['boom']
+    import gc
+    gc.collect()
+    actual = traceback.format_exc()
+
+assert actual.endswith('''  File "<string>", line 2, in boom
+    raise ValueError("boom")
+ValueError: boom'''), actual
@@ -5,4 +5,71 @@ class A:
 
 assert is_user_defined_type(A)
 assert not is_user_defined_type(int)
-assert not is_user_defined_type(dict)
\ No newline at end of file
+assert not is_user_defined_type(dict)
+
+import pkpy
+
+# the watchdog is armed from inside a running loop that makes no further calls
+if pkpy.configmacros['PK_ENABLE_WATCHDOG'] == 1:
+    def spin():
+        pkpy.watchdog_begin(50)
+        while True:
+            pass
+    try:
+        spin()
+        exit(1)
+    except TimeoutError:
+        pass
+    pkpy.watchdog_end()
+
+    # a fuel budget cuts off at the same point on every run
+    def count_until_exhausted(fuel):
+        n = [0]
+        pkpy.watchdog_begin_fuel(fuel)
+        try:
+            while True:
+                n[0] += 1
+        except TimeoutError:
+            pass
+        pkpy.watchdog_end()
+        return n[0]
+
+    a = count_until_exhausted(10000)
+    assert a > 0
+    assert a == count_until_exhausted(10000)
+    assert count_until_exhausted(20000) > a
+
+    def recurse():
+        recurse()
+    pkpy.watchdog_begin_fuel(100)
+    try:
+        recurse()
+        exit(1)
+    except TimeoutError:
+        pass
+    pkpy.watchdog_end()
+
+# live objects by type and by allocating line, and the changes between two censuses
+if pkpy.configmacros['PK_ENABLE_HEAP_PROFILER'] == 1:
+    class Node:
+        def __init__(self, i):
+            self.i = i
+
+    kept = []
+    before = pkpy.heap_census()
+    for i in range(200):
+        kept.append(Node(i))
+        garbage = [i]
+    diff = pkpy.heap_census(before)
+    count, nbytes, allocated = diff['types'][Node]
+    assert count == 200 and allocated == 200 and nbytes >= 200 * 16
+    # the lists are churn: created 200 times, at most one of them is alive
+    count, nbytes, allocated = diff['types'][list]
+    assert allocated == 200 and count <= 1
+    sites = [k for k, v in diff['sites'].items() if v[0] == 200 and v[2] == 200]
+    assert len(sites) == 1 and isinstance(sites[0][0], str)
+
+    kept.clear()
+    diff = pkpy.heap_census(before)
+    assert diff['types'][Node][0] == 0
+    assert pkpy.heap_census(pkpy.heap_census())['types'].get(Node) is None